@@ -12,12 +12,15 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 
+#include <algorithm>
 #include <vector>
 #include <chrono>
+#include <string>
 
 #include "window.hpp"
 #include "context.hpp"
 #include "shader_program.hpp"
+#include "trace.hpp"
 
 #include "gui_state.hpp"
 #include "fluid.hpp"
@@ -26,6 +29,7 @@ class AppState{
     unsigned int const m_windowDisplayScale;
     unsigned int const m_notionalWindowWidth;
     unsigned int const m_notionalWindowHeight;
+    unsigned int const m_maxTimeStep = 250000; // in us, so that a long frame doesn't destabilise the simulation
 public:
     AppState(unsigned int w, unsigned int h, unsigned int scale = 1);
     bool successfullyInitialised() const;
@@ -34,10 +38,13 @@ public:
     void handleEvents(SDL_Event const&  event);
     void frame(unsigned int frameTime);
     void quitApp();
+    bool writeFrameStatistics(std::string const& path);
     bool timeToQuit() const;
 private:
     bool m_quitApplication;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_tStart, m_tNow;
+    std::chrono::time_point<std::chrono::high_resolution_clock> const m_tLaunch; // Before the window is created
+    bool m_firstFramePresented;
     Window m_window;
     Context m_context;
     Fluid m_fluid;
@@ -0,0 +1,54 @@
+#ifndef _FLUID_ASSET_PACK_HPP_
+#define _FLUID_ASSET_PACK_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+/*
+    Read-only view of a pack of assets built by tools/pack_assets.cpp, memory-mapped in one go so that shader sources
+    and pixels are used in place. Images are stored decoded (or BC1-compressed), so textures are uploaded straight from
+    the mapping. Lookups take the same relative paths as the loose files (".//shaders//fluid.frag"), and anything not in
+    the pack is loaded from disk as before.
+
+    Layout: Header, then numEntries Entries sorted by name, then the names, then the payloads (each aligned to
+    payloadAlignment). All fields are little-endian. The mapping is kept until the process exits.
+ */
+class AssetPack{
+public:
+    static std::uint32_t constexpr fileMagic = 0x4b504c46; // "FLPK"
+    static std::uint32_t constexpr fileVersion = 1;
+    static std::uint64_t constexpr payloadAlignment = 16;
+    enum class Kind : std::uint32_t{
+        file, // Stored as is
+        image, // Decoded 8-bit pixels, rows top to bottom
+        imageBC1 // 4x4 blocks of 8 bytes, RGB only
+    };
+    struct Header{
+        std::uint32_t magic, version, numEntries, nameBytes;
+    };
+    struct Entry{
+        std::uint64_t offset, size; // Of the payload, from the start of the pack
+        std::uint32_t nameOffset, nameLength; // Into the names
+        Kind kind;
+        std::int32_t width, height, components; // Images only
+    };
+    AssetPack() = delete;
+    static bool open(std::string const& path);
+    static bool isOpen();
+    static Entry const* find(std::string const& path);
+    static unsigned char const* data(Entry const& entry);
+    static std::string normalise(std::string const& path);
+private:
+    static std::string_view name(Entry const& entry);
+    static unsigned char const* m_pack;
+    static std::uint64_t m_size;
+    static Header const* m_header;
+    static Entry const* m_entries;
+};
+
+#endif
\ No newline at end of file
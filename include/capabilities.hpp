@@ -0,0 +1,65 @@
+#ifndef _FLUID_CAPABILITIES_HPP_
+#define _FLUID_CAPABILITIES_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <utility>
+
+#include "gl_state_cache.hpp"
+
+/*
+    What the context can do, probed once it exists, and the simulation and render paths chosen from that.
+    Format and layered rendering support are probed by building small framebuffers rather than trusted from the
+    version number, as drivers differ in which float formats they can render to.
+
+    Slice paths decide how 3D textures (the simulation grids and the render volumes) are written: one draw per z-slice,
+    each into its own framebuffer, or one instanced draw into a layered framebuffer, with gl_Layer set by a geometry
+    shader or, where the driver allows it, by the vertex shader. The vector grids are RGB32F where that can be rendered
+    to, and RGBA32F otherwise.
+
+    The slice path may be forced, and capabilities disabled (so the paths are chosen as if they were missing), from the
+    command line. Both must be set before probe().
+ */
+class Capabilities{
+public:
+    enum class SlicePath{perSlice, geometryLayer, vertexLayer};
+    struct Features{
+        bool computeShaders = false; // Probed and reported; no path uses them yet
+        bool layeredRendering = false;
+        bool vertexShaderLayer = false;
+        bool textureBarrier = false; // Probed and reported; no path uses it yet
+        bool timerQueries = false;
+        bool floatTargets = false; // R32F and RGBA32F
+        bool rgbFloatTargets = false; // RGB32F, which is not required to be renderable
+        bool halfTargets = false; // R16F and RGBA16F. Probed and reported; the simulation's units are below half precision
+    };
+    Capabilities() = delete;
+    static bool disable(std::string const& feature);
+    static bool forceSlicePath(std::string const& path);
+    static void probe();
+    static void report();
+    static Features const& features();
+    static SlicePath slicePath();
+    static GLint vectorFormat();
+private:
+    static bool hasExtension(std::vector<std::string> const& extensions, char const* name);
+    static bool isRenderable(GLint internalFormat);
+    static bool isLayeredRenderable();
+    static bool* feature(std::string const& name);
+    static int m_majorVersion, m_minorVersion;
+    static Features m_features;
+    static std::vector<std::string> m_disabled;
+    static bool m_slicePathForced;
+    static SlicePath m_slicePath;
+};
+
+#endif
\ No newline at end of file
@@ -13,6 +13,12 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 
+#include "gl_call_counter.hpp"
+#include "gl_state_cache.hpp"
+#include "shader_cache.hpp"
+#include "shader_program.hpp"
+#include "capabilities.hpp"
+
 class Context{
 public:
     bool const useVsync = true;
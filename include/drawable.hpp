@@ -12,6 +12,8 @@
 #include <vector>
 #include <stdexcept>
 
+#include "gl_state_cache.hpp"
+
 class Drawable{
 public:
     Drawable() = delete;
@@ -24,6 +26,7 @@ public:
     void bindVAO() const;
     static void unbindVAO();
     void draw(GLint drawingMode = GL_TRIANGLES) const;
+    void drawInstanced(GLint drawingMode, GLsizei instances) const;
     bool successfullyInitialised() const;
 private:
     void setUpBuffers(unsigned int vertexDimension = 3);
@@ -23,9 +23,18 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "texture.hpp"
+#include "image_loader.hpp"
 #include "shader_program.hpp"
 #include "drawable.hpp"
 #include "vertex_data.hpp"
+#include "gpu_timer.hpp"
+#include "trace.hpp"
+#include "resolution_governor.hpp"
+#include "solver_scheduler.hpp"
+#include "marching_cubes_tables.hpp"
+#include "gl_state_cache.hpp"
+#include "slab_pass_graph.hpp"
+#include "capabilities.hpp"
 
 /* 
     M - FluidSimulator: Integrates the fluid each frame, reacting to input provided via public interface.
@@ -33,57 +42,104 @@
     C - Fluid: Passes input to the simulator via interface and ensures the renderer has access to the level set.
  */
 
-static int const gridSize = 32;
+#ifndef FLUID_GRID_SIZE
+#define FLUID_GRID_SIZE 32 // May be overridden when building, e.g. to benchmark other grid sizes
+#endif
+static int const gridSize = FLUID_GRID_SIZE;
+static int const renderGridSize = 2 * gridSize; // Resolution of the upsampled level set used for rendering
 
 class FluidSimulator{
     float const gravitationalFieldStrength = 9.81;
     float const fluidDensityRho = 997;
-    int const numJacobiIterationsDiffusion = 25;
-    int const numJacobiIterationsPressure = 50;
+    static GLuint constexpr m_gridConstantsBinding = 0; // Uniform buffer binding points, as used by every slab operation
+    static GLuint constexpr m_frameConstantsBinding = 1;
 public:
     FluidSimulator();
+    void initialiseShaders();
     void update(unsigned int frameTime);
     bool successfullyInitialised() const;
     GLuint getCurrentLevelSet() const;
-    void resetLevelSet() const;
+    GLuint getRenderLevelSet() const;
+    GLuint getDetailCoordinates() const;
+    GLuint getVelocity() const;
+    std::size_t getTextureBytes() const;
+    unsigned int getLevelSetGeneration() const;
+    void setDetailAdvection(bool advectDetail);
+    void setInitialLevelSet(std::vector<float> const& levelSet);
+    void resetLevelSet();
     void updateAppliedForce(glm::vec3 force);
+    void setSolverIterations(int diffusionIterations, int pressureIterations);
+    SolverTimings getSolverTimings() const;
+    void getStageTimes(std::vector<GPUStageTime>& stageTimes) const;
 private:
-    void initialiseUniforms();
     void initialiseTextures();
-    void initialiseFramebufferObjects();
+    bool buildPassGraph();
     void integrateFluid(unsigned int frameTime);
-    struct SimulatedQuantity{
-        GLuint texture;
-        GLuint slabFBOs[gridSize];
-        void generateTexture(std::vector<float> data, bool scalarQuantity);
-        void generateFBOs();
-    };
     struct SlabOperation{
-        SlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames);
+        SlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines = {});
+        void initialiseUniforms();
         ShaderProgram shader;
-        GLuint uniformZSlice, uniformTimeStep;
-        DrawableUniformLocations quadUniforms;
+        std::vector<std::string> textureNames; // Bound to the texture unit matching their position
+        GLint uniformSlice;
     };
     struct InnerSlabOperation : public SlabOperation{
-        InnerSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames);
+        InnerSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines = {});
     };
     struct OuterSlabOperation : public SlabOperation{
-        OuterSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames);
+        OuterSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines = {});
     };
-    void applySlabOp(SlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime, int layerFrom, int layerTo) const;
-    void applyInnerSlabOp(InnerSlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime) const;
-    void applyOuterSlabOp(OuterSlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime) const;
+    void applySlabOp(SlabOperation const& slabOp, SlabPassGraph::Texture const& target, int layerFrom, int layerTo) const;
+    void applyInnerSlabOp(InnerSlabOperation const& slabOp, SlabPassGraph::Texture const& target) const;
+    void applyOuterSlabOp(OuterSlabOperation const& slabOp, SlabPassGraph::Texture const& target) const;
+    void iterateDiffusion(SlabPassGraph::Texture const& velocity, SlabPassGraph::Texture const& scratch) const;
+    void iteratePressure(SlabPassGraph::Texture const& pressure, SlabPassGraph::Texture const& scratch) const;
+    // Inner slab operations leave the boundary of their result undefined unless they write over a resource, outer ones
+    // write the whole grid
+    SlabPassGraph::Resource addSlabPass(char const* name, InnerSlabOperation const& slabOp, GPUTimer* stage, std::vector<SlabPassGraph::Input> const& inputs, GLint outputFormat, SlabPassGraph::Resource writesOver = -1);
+    SlabPassGraph::Resource addSlabPass(char const* name, OuterSlabOperation const& slabOp, GPUTimer* stage, std::vector<SlabPassGraph::Input> const& inputs, GLint outputFormat);
 private:
     bool m_successfullyInitialised;
+    int m_numJacobiIterationsDiffusion = 25;
+    int m_numJacobiIterationsPressure = 50;
+    GPUTimer m_integrationTimer{"Simulation"}, m_diffusionTimer{"Diffusion"}, m_pressureTimer{"Pressure"};
+    GPUTimer m_forceTimer{"Force"}, m_boundaryTimer{"Velocity BC"}, m_advectionTimer{"Advection"};
+    GPUTimer m_divergenceTimer{"Divergence"}, m_gradientTimer{"Gradient"}, m_levelSetTimer{"Level set"};
     Drawable m_quad{std::vector<float>(quadVerts, quadVerts + quadVertsSize), 2u};
-    SimulatedQuantity m_velocityCurrent, m_velocityNext;
-    SimulatedQuantity m_levelSetCurrent, m_levelSetNext;
-    SimulatedQuantity m_pressureCurrent, m_pressureNext;
-    SimulatedQuantity m_tempVectorQuantity, m_tempScalarQuantity; // for use in performing iterations
+    // The integration step, rebuilt whenever detail advection changes
+    SlabPassGraph m_passGraph{gridSize};
+    bool m_passGraphDeclared = false;
+    // Format of the vector quantities, chosen by Capabilities
+    GLint const m_vectorFormat = Capabilities::vectorFormat();
+    // Persistent quantities of m_passGraph. Every temporary is allocated by the graph from its texture pool
+    int m_velocity, m_levelSet, m_pressure;
+    // Earlier versions of the quantities, kept for the boundary texels of the inner passes that write over them
+    int m_previousVelocityBC, m_previousAdvectedVelocity, m_previousAdvectedLevelSet, m_previousDetailCoordinates;
+    // Narrow-band R16 copy of the level set for the renderer, holding clamp(phi / 4 voxels, -1, 1) remapped to [0, 1]
+    int m_levelSetRender;
+    // Texture coordinates advected with the flow, used by the renderer to move procedural surface detail with the fluid
+    int m_detailCoordinates;
+    bool m_advectDetail = false;
+    unsigned int m_levelSetGeneration = 0; // Incremented whenever the level set is republished: every step, and on reset
     InnerSlabOperation m_advectionLevelSet, m_advectionVelocity, m_diffusion, m_forceApplication, m_passThrough, m_pressurePoisson, m_divergence, m_removeDivergence;
-    OuterSlabOperation m_boundaryVelocity, m_boundaryLevelSet, m_boundaryPressure, m_clearSlabs;
-    std::vector<float> m_initialLevelSetData, m_initialVelocityData;
-    GLuint uniformAppliedForcePosition, uniformAppliedForce;
+    InnerSlabOperation m_advectionDetail;
+    OuterSlabOperation m_boundaryVelocity, m_boundaryLevelSet, m_boundaryPressure, m_clearSlabs, m_encodeLevelSet;
+    std::vector<float> m_initialLevelSetData, m_initialVelocityData, m_initialDetailCoordinatesData;
+    // std140 uniform buffers shared by all slab operations, so per-frame uniforms are a single buffer update
+    struct SharedConstants{
+        SharedConstants();
+        SharedConstants(SharedConstants const&) = delete;
+        SharedConstants(SharedConstants const&&) = delete;
+        SharedConstants& operator=(SharedConstants const&) = delete;
+        SharedConstants& operator=(SharedConstants const&&) = delete;
+        ~SharedConstants();
+        struct FrameConstants{ // As the FrameConstants block in shaders/
+            float timeStep; // in microseconds
+            float padding[3];
+            glm::vec4 appliedForce;
+        };
+        GLuint gridConstantsUBO, frameConstantsUBO;
+        void update(unsigned int frameTime, glm::vec3 appliedForce) const;
+    } m_sharedConstants;
     glm::vec3 m_appliedForce;
 };
 
@@ -92,18 +148,44 @@ class FluidRenderer{
     float const planeSize = 10.0f;
     int const m_splineResolution = 128;
     glm::vec3 const m_cameraIntialPos = glm::vec3(0.0f, 1.5f, 3.0f);
+    float const m_fluidFrameBudget = 8.3f; // in ms
+    float const m_minRenderScale = 0.5f;
+    unsigned int const m_heightfieldHysteresis = 10; // Overhang-free frames required before using the heightfield
     unsigned int const m_screenWidth;
     unsigned int const m_screenHeight;
 public:
+    enum class SurfaceMode{rayMarching, marchingCubes};
     FluidRenderer(unsigned int width, unsigned int height);
     void updateCamera(float cameraHorizontalRotation, float cameraVerticalRotation);
-    void render(GLuint currentLevelSetTexture) const;
+    void render(GLuint currentLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration);
     bool successfullyInitialised() const;
+    float getRenderTime() const;
+    void getStageTimes(std::vector<GPUStageTime>& stageTimes) const;
+    void toggleSurfaceMode();
+    void toggleHeightfieldFastPath();
+    void toggleCellTraversal();
+    void setAdaptiveResolution(bool adaptive);
+    void setLevelSetDetail(bool addDetail);
+    void renderViews(std::vector<glm::mat4> const& viewMatrices, unsigned int width, unsigned int height,
+                     GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration);
+    bool readViews(std::vector<unsigned char>& pixels, bool wait = false);
+    GLuint getViewsTexture() const;
 private:
     void initialiseShaders();
     void setUpSkybox();
+    void bakeEnvironment();
     void renderBackground() const;
     void renderFluid(GLuint currentLevelSetTexture) const;
+    void updateVolumes(GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration);
+    void upsampleLevelSet(GLuint currentLevelSetTexture, GLuint detailCoordinatesTexture);
+    void computeTransmittance();
+    void extractSurface(GLuint currentLevelSetTexture);
+    void renderSurfaceMesh(GLuint currentLevelSetTexture);
+    void reduceHeightfield(GLuint currentLevelSetTexture);
+    void pollHeightfieldOverhangs();
+    void renderHeightfield(GLuint currentLevelSetTexture) const;
+    void compositeFluid() const;
+    void updateRenderResolution();
     void setUpSplines();
 private:
     bool m_successfullyInitialised;
@@ -117,36 +199,163 @@ private:
         float yaw = 0.0f, pitch = 1.0f;
         void updateMatrix();
     } m_camera;
-    GLuint m_skyBoxTexture, m_uniformSkyBoxTexture;
+    GLuint m_skyBoxTexture;
     std::vector<std::string> m_skyBoxPaths = {".//skybox//miramar_lf.tga", ".//skybox//miramar_rt.tga",
                                             ".//skybox//miramar_up.tga", ".//skybox//miramar_dn.tga",
                                             ".//skybox//miramar_ft.tga", ".//skybox//miramar_bk.tga"};
+    std::vector<std::future<ImageLoader::Image>> m_skyBoxImages = ImageLoader::load(m_skyBoxPaths); // Decoded while the shaders compile
+    // The static scene (skybox, floor and spotlight) as seen from the centre of the tank, so secondary rays need a
+    // single fetch. Rebaked only when invalidated by a change to the scene
+    struct EnvironmentProbe{
+        EnvironmentProbe();
+        EnvironmentProbe(EnvironmentProbe const&) = delete;
+        EnvironmentProbe(EnvironmentProbe const&&) = delete;
+        EnvironmentProbe& operator=(EnvironmentProbe const&) = delete;
+        EnvironmentProbe& operator=(EnvironmentProbe const&&) = delete;
+        ~EnvironmentProbe();
+        static int constexpr faceSize = 512;
+        GLuint environmentTexture; // Floor blended with the skybox, for reflected rays
+        GLuint floorTexture; // Floor only, for refracted rays
+        GLuint faceFBOs[6];
+        bool valid = false;
+    } m_environmentProbe;
     struct RenderTarget{
-        RenderTarget(unsigned int width, unsigned int height);
+        RenderTarget(unsigned int width, unsigned int height, GLint format = GL_RGB, bool depthBuffer = false);
         RenderTarget(RenderTarget const&) = delete;
         RenderTarget(RenderTarget const&&) = delete;
         RenderTarget& operator=(RenderTarget const&) = delete;
         RenderTarget& operator=(RenderTarget const&&) = delete;
         ~RenderTarget();
         GLuint FBO;
+        GLuint depthRBO = 0;
         Texture texture;
         GLuint uniformTexture;
-        void setUpBuffers();
+        void setUpBuffers(bool depthBuffer);
         void releaseBuffers();
-    } m_frontCube, m_backCube;
+        void resize(unsigned int width, unsigned int height);
+    } m_frontCube, m_backCube, m_fluidTarget;
+    // Surface triangles captured by transform feedback. Capture is double buffered: the last mesh whose triangle count
+    // has been read back is drawn while the other is written, and a new capture waits until the GPU has finished the
+    // one before it, so the count is never read before it is available. A capture that overflows its buffer grows the
+    // buffers, and the fluid is ray marched until a complete mesh can be drawn
+    struct SurfaceMesh{
+        SurfaceMesh();
+        SurfaceMesh(SurfaceMesh const&) = delete;
+        SurfaceMesh(SurfaceMesh const&&) = delete;
+        SurfaceMesh& operator=(SurfaceMesh const&) = delete;
+        SurfaceMesh& operator=(SurfaceMesh const&&) = delete;
+        ~SurfaceMesh();
+        static unsigned int constexpr numCells = (renderGridSize - 1) * (renderGridSize - 1) * (renderGridSize - 1);
+        static unsigned int constexpr maxTriangles = 5 * numCells; // At most five per cell
+        static unsigned int constexpr floatsPerVertex = 6; // Position, normal
+        unsigned int triangleCapacity = 32 * renderGridSize * renderGridSize; // Grown when a capture overflows
+        unsigned int bufferCapacities[2] = {0, 0};
+        GLuint VAOs[2], VBOs[2], primitivesQueries[2], generatedQueries[2];
+        GLuint extractionVAO; // Attribute-less, cells are indexed by gl_VertexID
+        GLuint triangleTableTexture;
+        unsigned int capturing = 0, drawn = 1;
+        bool pending = false; // If the triangle count of the capture has not been read back yet
+        GLuint numTriangles = 0; // In the drawn mesh
+        bool complete = false; // If there is a drawn mesh, and it has every triangle extracted
+        void reserve(unsigned int buffer);
+        bool collect();
+        void reset();
+    } m_surfaceMesh;
+    SurfaceMode m_surfaceMode = SurfaceMode::rayMarching;
+    // A cubic 3D texture rendered to one slab per FBO, or all at once through the layered FBO
+    struct VolumeTarget{
+        VolumeTarget(int size, GLint format);
+        VolumeTarget(VolumeTarget const&) = delete;
+        VolumeTarget(VolumeTarget const&&) = delete;
+        VolumeTarget& operator=(VolumeTarget const&) = delete;
+        VolumeTarget& operator=(VolumeTarget const&&) = delete;
+        ~VolumeTarget();
+        int const size;
+        GLuint texture;
+        std::vector<GLuint> slabFBOs;
+        GLuint layeredFBO = 0;
+    };
+    void renderVolume(VolumeTarget const& target, GLint uniformSlice) const;
+    // The simulation level set is reconstructed at renderGridSize with tricubic B-splines
+    VolumeTarget m_upsampledLevelSet{renderGridSize, GL_R16};
+    bool m_levelSetDetail = false;
+    // Light-space transmittance (R) and caustic factor / 2 (G), so the floor is shadowed with a single fetch
+    VolumeTarget m_transmittance{gridSize, GL_RG8};
+    // Both volumes above are recomputed once per simulation step, and reused by any further frames or views of it
+    bool m_volumesValid = false;
+    unsigned int m_volumesGeneration = 0;
+    // Views of the scene from many cameras, rendered into the layers of a texture array and read back asynchronously
+    struct MultiViewTarget{
+        MultiViewTarget();
+        MultiViewTarget(MultiViewTarget const&) = delete;
+        MultiViewTarget(MultiViewTarget const&&) = delete;
+        MultiViewTarget& operator=(MultiViewTarget const&) = delete;
+        MultiViewTarget& operator=(MultiViewTarget const&&) = delete;
+        ~MultiViewTarget();
+        static unsigned int constexpr maxViewsPerPass = 16; // As in multiview.frag
+        GLuint texture = 0, FBO, VAO; // VAO is attribute-less
+        unsigned int width = 0, height = 0, layers = 0;
+        GLuint PBOs[2];
+        GLsync fences[2] = {0, 0};
+        unsigned int current = 0;
+        void resize(unsigned int newWidth, unsigned int newHeight, unsigned int newLayers);
+        void releaseFences();
+    } m_multiView;
+    // Normals and coarse occupancy of the render level set, shared by every view and invalidated with the volumes above
+    VolumeTarget m_normals{renderGridSize, GL_RGBA8};
+    VolumeTarget m_occupancy{renderGridSize / 4, GL_R8};
+    bool m_viewVolumesValid = false;
+    // Per-(x,z) column surface heights (R) and overhang flags (G). The flags are averaged down the mip chain and the
+    // last level is read back asynchronously, so the ray marcher is only used when some column is not single-valued
+    struct Heightfield{
+        Heightfield();
+        Heightfield(Heightfield const&) = delete;
+        Heightfield(Heightfield const&&) = delete;
+        Heightfield& operator=(Heightfield const&) = delete;
+        Heightfield& operator=(Heightfield const&&) = delete;
+        ~Heightfield();
+        GLuint texture, FBO;
+        GLint topMipLevel;
+        GLuint VAO, EBO; // Attribute-less grid, columns are indexed by gl_VertexID
+        GLsizei numIndices;
+        GLuint PBOs[2];
+        GLsync fences[2] = {0, 0};
+        unsigned int current = 0;
+        unsigned int framesWithoutOverhangs = 0;
+    } m_heightfield;
+    bool m_heightfieldFastPath = true;
+    bool m_cellTraversal = false; // Ray march by exact 3D-DDA cell traversal rather than fixed steps
+    // Ray marching is performed at a reduced internal resolution chosen to hold the fluid pass within budget
+    unsigned int m_renderWidth, m_renderHeight;
+    ResolutionGovernor m_resolutionGovernor;
+    bool m_adaptiveResolution = true;
+    GPUTimer m_renderTimer{"Render"}, m_renderFluidTimer{"Fluid"};
+    GPUTimer m_volumesTimer{"Volumes"}, m_surfaceTimer{"Surface"}, m_backgroundTimer{"Background"}, m_compositeTimer{"Composite"};
     Drawable m_cube{std::vector<float>(cubeVerts, cubeVerts + cubeVertsSize), 3u};
     Drawable m_quad{std::vector<float>(quadVerts, quadVerts + quadVertsSize), 2u};
     Drawable m_backgroundPlane{std::vector<float>(backgroundPlaneVerts, backgroundPlaneVerts + backgroundPlaneVertsSize), 2u};
-    DrawableUniformLocations m_renderFluidUniforms, m_raycastingPosUniforms, m_backgroundPlaneUniforms;
-    GLuint m_uniformLevelSetFluid;
+    DrawableUniformLocations m_renderFluidUniforms, m_raycastingPosUniforms, m_backgroundPlaneUniforms, m_compositeFluidUniforms, m_renderMeshUniforms;
+    DrawableUniformLocations m_reduceHeightfieldUniforms, m_renderHeightfieldUniforms, m_upsampleLevelSetUniforms, m_computeTransmittanceUniforms, m_bakeEnvironmentUniforms;
+    DrawableUniformLocations m_computeNormalsUniforms, m_computeOccupancyUniforms;
+    GLuint m_uniformLevelSetFluid, m_uniformCameraPositionMesh, m_uniformCameraPositionHeightfield;
+    GLint m_uniformSliceTransmittance, m_uniformFaceBake;
+    std::vector<GLint> m_uniformSliceUpsample; // Per variant
     GLuint m_splineTexture, m_uniformSplineTexture, m_splineDerivTexture, m_uniformSplineDerivTexture;
-    ShaderProgram m_backgroundPlaneShader, m_raycastingPosShader, m_renderFluidShader;
+    ShaderProgram m_backgroundPlaneShader, m_raycastingPosShader, m_compositeFluidShader, m_extractSurfaceShader, m_renderMeshShader;
+    ShaderProgram m_reduceHeightfieldShader, m_renderHeightfieldShader, m_computeTransmittanceShader;
+    ShaderProgram m_bakeEnvironmentShader, m_multiViewShader, m_computeNormalsShader, m_computeOccupancyShader;
+    ShaderVariants m_renderFluidShader; // Indexed by m_cellTraversal
+    ShaderVariants m_upsampleLevelSetShader; // Indexed by m_levelSetDetail
+    GLint m_uniformFirstLayerMultiView, m_uniformInverseViewProjections, m_uniformCameraPositions, m_uniformSliceNormals, m_uniformSliceOccupancy;
 };
 
 class Fluid{
     float const m_cameraRotationSpeed = glm::radians(2e-5);
     float const m_cameraMaxVerticalRotation = 0.2 * std::numbers::pi_v<float>;
     float const m_cameraMinVerticalRotation = -0.2 * std::numbers::pi_v<float>;
+    float const m_frameBudget = 16.6f; // in ms
+    SolverBounds const m_diffusionBounds{5, 25};
+    SolverBounds const m_pressureBounds{20, 50};
 public:
     Fluid() = delete;
     Fluid(unsigned int w, unsigned int h);
@@ -158,17 +367,22 @@ public:
     bool successfullyInitialised() const;
     void handleEvents(SDL_Event const& event);
     void frame(unsigned int frameTime);
+    std::vector<GPUStageTime> getStageTimes() const;
 private:
     void updateForce();
     void updateCamera(unsigned int frameTime);
+    void updateSolverIterations();
+    void toggleLevelSetDetail();
     bool m_successfullyInitialised;
     FluidSimulator m_simulator;
     FluidRenderer m_renderer;
+    SolverScheduler m_solverScheduler;
     int m_cameraHorizontalRotationDirection;
     float m_cameraHorizontalRotation;
     int m_cameraVerticalRotationDirection;
     float m_cameraVerticalRotation;
     bool m_applyingForce;
+    bool m_levelSetDetail;
     int m_forceMouseStartX, m_forceMouseStartY;
     int m_forceMouseEndX, m_forceMouseEndY;
 };
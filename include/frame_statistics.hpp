@@ -0,0 +1,43 @@
+#ifndef _FLUID_FRAME_STATISTICS_HPP_
+#define _FLUID_FRAME_STATISTICS_HPP_
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/* 
+    Keeps the lengths of recent frames in a fixed ring, so recording a frame never allocates or locks, and summarises 
+    the distribution of any number of the most recent frames. Tail percentiles, the longest frame and the number of 
+    hitches (frames taking more than twice the median) expose stutter that an average hides.
+    Summaries can be appended to a CSV file for offline analysis.
+ */
+class FrameStatistics{
+    static std::size_t constexpr m_capacity = 4096; // Frames, must be a power of two
+    static unsigned int constexpr m_hitchFactor = 2;
+public:
+    static std::size_t constexpr numHistogramBins = 7;
+    static constexpr std::array<unsigned int, numHistogramBins - 1> histogramBinEdges{8333, 16667, 25000, 33333, 50000, 100000}; // in us
+    struct Summary{
+        std::size_t numFrames;
+        float mean, p50, p95, p99, max; // in ms
+        unsigned int hitches;
+        std::array<unsigned int, numHistogramBins> histogram;
+    };
+    FrameStatistics();
+    void addFrame(unsigned int frameTime);
+    Summary summarise(std::size_t numFrames);
+    bool openCSV(std::string const& path);
+    void writeCSV(float time, Summary const& summary);
+    static void log(float duration, Summary const& summary);
+private:
+    std::array<unsigned int, m_capacity> m_frameTimes; // in us
+    std::array<unsigned int, m_capacity> m_sortedFrameTimes; // Scratch space for summarise()
+    std::size_t m_numFrames;
+    std::ofstream m_csvFile;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef _FLUID_GL_CALL_COUNTER_HPP_
+#define _FLUID_GL_CALL_COUNTER_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* 
+    Optional instrumentation layer that replaces the function pointers loaded by glad with wrappers which count each 
+    call before forwarding it. Alongside per-entry-point call counts, it tracks draws, bytes uploaded to buffers and 
+    textures, and binds of programs, framebuffers, vertex arrays and textures. A shadow copy of the bound state is used 
+    to count how many of those binds were redundant, so that work to eliminate state changes can be measured.
+
+    Counts are accumulated over a frame and published by endFrame(). The wrappers are only installed (by Context) when 
+    built with FLUID_COUNT_GL_CALLS defined, so otherwise calls go straight to the driver and every count reads zero.
+ */
+class GLCallCounter{
+    static unsigned int constexpr m_maxTextureUnits = 32;
+    static unsigned int constexpr m_numTextureTargets = 5;
+public:
+    struct FrameCounts{
+        unsigned long calls, draws, uniformUpdates;
+        unsigned long programBinds, redundantProgramBinds;
+        unsigned long framebufferBinds, redundantFramebufferBinds;
+        unsigned long vertexArrayBinds, redundantVertexArrayBinds;
+        unsigned long textureBinds, redundantTextureBinds;
+        unsigned long long bytesUploaded;
+    };
+    GLCallCounter() = delete;
+    static void install();
+    static bool isInstalled();
+    static void endFrame();
+    static FrameCounts const& getFrameCounts();
+    static void dump(std::ostream& stream);
+private:
+    template <auto& pointer, auto observer, typename Function> friend struct CountedEntryPoint;
+    static std::size_t addEntryPoint(char const* name);
+    static void observeUseProgram(GLuint program);
+    static void observeBindFramebuffer(GLenum target, GLuint framebuffer);
+    static void observeDeleteFramebuffers(GLsizei n, GLuint const* framebuffers);
+    static void observeBindVertexArray(GLuint array);
+    static void observeDeleteVertexArrays(GLsizei n, GLuint const* arrays);
+    static void observeActiveTexture(GLenum texture);
+    static void observeBindTexture(GLenum target, GLuint texture);
+    static void observeDeleteTextures(GLsizei n, GLuint const* textures);
+    static void observeBufferData(GLenum target, GLsizeiptr size, void const* data, GLenum usage);
+    static void observeBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void const* data);
+    static void observeTexImage1D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLint border, GLenum format, GLenum type, void const* pixels);
+    static void observeTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, void const* pixels);
+    static void observeTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, void const* pixels);
+    static void observeTexSubImage3D(GLenum target, GLint level, GLint xOffset, GLint yOffset, GLint zOffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, void const* pixels);
+    static void observeCompressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, void const* data);
+    static void countDraw();
+    static void countUniformUpdate();
+    static unsigned long long pixelSize(GLenum format, GLenum type);
+    static bool m_installed;
+    static std::vector<char const*> m_entryPointNames;
+    static std::vector<unsigned long> m_entryPointCalls, m_entryPointCallsLastFrame; // Indexed as m_entryPointNames
+    static FrameCounts m_counts, m_lastFrameCounts;
+    // Shadow of the bound state
+    static GLuint m_program, m_drawFramebuffer, m_readFramebuffer, m_vertexArray;
+    static unsigned int m_activeTextureUnit;
+    static std::array<std::array<GLuint, m_numTextureTargets>, m_maxTextureUnits> m_textures;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef _FLUID_GL_STATE_CACHE_HPP_
+#define _FLUID_GL_STATE_CACHE_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <array>
+#include <algorithm>
+
+/* 
+    Thin layer over the GL calls that set bound objects and fixed-function state, which skips any call that would not 
+    change the current state. It mirrors the GL functions it replaces, so it must be used for every such call (and for 
+    deleting objects that may be bound) for its copy of the state to remain correct. Other capabilities passed to 
+    enable() and disable() are forwarded without being tracked.
+
+    Framebuffer 0 may be replaced by setDefaultFramebuffer(), so that code rendering to the window renders to an
+    offscreen target instead when there is none.
+
+    The number of calls requested and elided in each frame is published by endFrame().
+ */
+class GLStateCache{
+    static unsigned int constexpr m_maxTextureUnits = 16; // Binds on higher units are always issued
+    static unsigned int constexpr m_numTextureTargets = 5;
+    static GLuint constexpr m_unknown = ~0u;
+public:
+    struct FrameStatistics{
+        unsigned long requested, elided;
+    };
+    GLStateCache() = delete;
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint array);
+    static void bindFramebuffer(GLenum target, GLuint framebuffer);
+    static void setDefaultFramebuffer(GLuint framebuffer);
+    static void activeTexture(GLenum texture);
+    static void bindTexture(GLenum target, GLuint texture);
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    static void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    static void enable(GLenum capability);
+    static void disable(GLenum capability);
+    static void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+    static void deleteProgram(GLuint program);
+    static void deleteVertexArrays(GLsizei n, GLuint const* arrays);
+    static void deleteFramebuffers(GLsizei n, GLuint const* framebuffers);
+    static void deleteTextures(GLsizei n, GLuint const* textures);
+    static void invalidate();
+    static void endFrame();
+    static FrameStatistics const& getFrameStatistics();
+private:
+    static bool request(bool redundant);
+    static int capabilityIndex(GLenum capability);
+    static void setCapability(GLenum capability, bool enabled);
+    static FrameStatistics m_statistics, m_lastFrameStatistics;
+    static GLuint m_program, m_vertexArray, m_drawFramebuffer, m_readFramebuffer;
+    static GLuint m_defaultFramebuffer; // Bound in place of 0
+    static unsigned int m_activeTextureUnit;
+    static std::array<std::array<GLuint, m_numTextureTargets>, m_maxTextureUnits> m_textures;
+    static std::array<GLint, 4> m_viewport, m_scissor;
+    static std::array<int, 4> m_capabilities; // Blend, scissor test, face culling, depth test. 1 or 0 if known, else -1
+    static std::array<GLenum, 2> m_blendFunc;
+};
+
+#endif
\ No newline at end of file
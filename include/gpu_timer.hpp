@@ -0,0 +1,62 @@
+#ifndef _FLUID_GPU_TIMER_HPP_
+#define _FLUID_GPU_TIMER_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include "trace.hpp"
+#include "capabilities.hpp"
+
+/* 
+    Measures the GPU time taken by the commands issued between begin() and end() using a pair of timestamp queries.
+    Queries are cycled through a small ring and only read back once the GPU reports them as available, so timing 
+    never stalls the pipeline. Results therefore lag the current frame by a frame or two.
+    Timers given a name also report each result to the Tracer as a GPU span.
+    Without timer queries (see Capabilities) timers never have a result.
+    Alongside the rolling average for display, each timer keeps the mean of its results since resetMeans() was last
+    called (on every timer at once), for benchmarking.
+ */
+class GPUTimer{
+    static unsigned int const m_numQueryFrames = 3;
+    static constexpr float m_averageSmoothingFactor = 0.05f;
+public:
+    explicit GPUTimer(char const* traceName = nullptr);
+    GPUTimer(GPUTimer const&) = delete;
+    GPUTimer(GPUTimer const&&) = delete;
+    GPUTimer& operator=(GPUTimer const&) = delete;
+    GPUTimer& operator=(GPUTimer const&&) = delete;
+    ~GPUTimer();
+    void begin();
+    void end();
+    bool hasResult() const;
+    float getElapsedTime() const;
+    float getAverageTime() const;
+    float getMeanTime() const;
+    static void resetMeans();
+private:
+    void collectResults();
+    static unsigned int m_meanGeneration; // Incremented by resetMeans()
+    char const* const m_traceName;
+    GLuint m_queries[m_numQueryFrames][2];
+    bool m_pending[m_numQueryFrames];
+    unsigned int m_currentFrame;
+    bool m_hasResult;
+    float m_elapsedTime; // in ms
+    float m_averageTime; // Exponential moving average of m_elapsedTime, in ms
+    unsigned int m_generation; // Of the results summed in m_totalTime
+    double m_totalTime; // in ms
+    unsigned int m_numResults;
+};
+
+// Rolling average GPU time of a named stage of the frame, for display
+struct GPUStageTime{
+    char const* name;
+    float time; // in ms
+    float meanTime; // Since GPUTimer::resetMeans(), in ms
+};
+
+#endif
\ No newline at end of file
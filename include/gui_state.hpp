@@ -11,15 +11,30 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 
+#include <vector>
+#include <cstdio>
+
 #include "text_renderer.hpp"
+#include "gpu_timer.hpp"
+#include "gl_call_counter.hpp"
+#include "gl_state_cache.hpp"
 
 class GUIState{
+    float const m_timingTextScale = 8.0f;
 public:
     GUIState(unsigned int width, unsigned int height);
     bool successfullyInitialised() const;
+    void addText(std::string const& text, float scale, float xPos, float yPos);
+    void addStageTimes(std::vector<GPUStageTime> const& stageTimes);
+    void addStateCacheStatistics(GLStateCache::FrameStatistics const& statistics);
+    void addGLCallCounts(GLCallCounter::FrameCounts const& counts);
+    void toggleTimingHUD();
+    bool isTimingHUDVisible() const;
     void frame();
 private:
     TextRenderer m_textRen;
+    bool m_timingHUDVisible = false;
+    float m_timingTextLine; // Position of the next line of the timing HUD
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef _FLUID_HEADLESS_HPP_
+#define _FLUID_HEADLESS_HPP_
+
+#ifdef FLUID_HEADLESS
+
+#include "glad/glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "gl_call_counter.hpp"
+#include "gl_state_cache.hpp"
+#include "shader_cache.hpp"
+#include "shader_program.hpp"
+#include "capabilities.hpp"
+#include "trace.hpp"
+#include "fluid.hpp"
+
+/*
+    GL context for running without a window, created through EGL: on Mesa's surfaceless platform where it is available
+    (so llvmpipe works on machines without a GPU or display server), otherwise on the default display, with a small
+    pbuffer if the driver cannot make a context current without a surface. Frames are rendered to an offscreen
+    framebuffer of the given size, which GLStateCache binds in place of the window's.
+ */
+class HeadlessContext{
+public:
+    HeadlessContext(unsigned int width, unsigned int height);
+    ~HeadlessContext();
+    HeadlessContext(HeadlessContext const&) = delete;
+    HeadlessContext(HeadlessContext const&&) = delete;
+    HeadlessContext& operator=(HeadlessContext const&) = delete;
+    HeadlessContext& operator=(HeadlessContext const&&) = delete;
+    bool successfullyInitialised() const;
+    bool writeImage(std::string const& path) const;
+    unsigned int const width;
+    unsigned int const height;
+private:
+    static bool hasExtension(char const* extensions, char const* name);
+    void createFramebuffer();
+    EGLDisplay m_display = EGL_NO_DISPLAY;
+    EGLSurface m_surface = EGL_NO_SURFACE;
+    EGLContext m_context = EGL_NO_CONTEXT;
+    GLuint m_framebuffer = 0;
+    GLuint m_renderbuffers[2] = {0, 0}; // Colour and depth
+    bool m_successfullyInitialised = false;
+};
+
+/*
+    Batch counterpart of AppState: runs a fixed number of steps back to back with a fixed time step, with no event loop,
+    vsync or GUI, so as many steps run each second as the GPU allows. Without rendering only the simulator is created.
+ */
+class HeadlessApp{
+public:
+    struct Settings{
+        unsigned int steps = 1000;
+        unsigned int timeStep = 16667; // in us, as frameTime is elsewhere
+        bool render = true;
+        unsigned int width = 1280;
+        unsigned int height = 960;
+        std::string imagePath; // PPM of the last frame, if not empty and rendering
+    };
+    explicit HeadlessApp(Settings const& settings);
+    HeadlessApp(HeadlessApp const&) = delete;
+    HeadlessApp(HeadlessApp const&&) = delete;
+    HeadlessApp& operator=(HeadlessApp const&) = delete;
+    HeadlessApp& operator=(HeadlessApp const&&) = delete;
+    bool successfullyInitialised() const;
+    void run();
+private:
+    void step();
+    Settings const m_settings;
+    HeadlessContext m_context;
+    std::unique_ptr<Fluid> m_fluid; // When rendering
+    std::unique_ptr<FluidSimulator> m_simulator; // Otherwise
+    bool m_successfullyInitialised = false;
+};
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef _FLUID_IMAGE_LOADER_HPP_
+#define _FLUID_IMAGE_LOADER_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <algorithm>
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#include "stb_image.h"
+#include "asset_pack.hpp"
+
+/*
+    Decodes image files on a small pool of worker threads, so that startup can decode textures while the GL thread
+    issues shader compiles. Only the decoding happens on the workers: whoever uploads the pixels waits on the returned
+    future from the GL thread. The workers are started by the first load and joined at exit.
+
+    Images in the asset pack are already decoded, so are returned ready, pointing into the pack.
+    Without threads (Emscripten) images are decoded by load() itself.
+ */
+class ImageLoader{
+    static unsigned int constexpr m_maxWorkers = 4;
+public:
+    enum class Compression{none, bc1};
+    struct Image{
+        int width = 0, height = 0, components = 0;
+        Compression compression = Compression::none;
+        std::size_t size = 0; // of data, in bytes
+        std::shared_ptr<unsigned char const> data; // Empty if decoding failed
+    };
+    ImageLoader() = delete;
+    static std::future<Image> load(std::string const& path);
+    static std::vector<std::future<Image>> load(std::vector<std::string> const& paths);
+    static Image decompress(Image const& image);
+private:
+    static Image decode(std::string const& path);
+    static Image decode(unsigned char const* file, std::size_t size);
+    static Image fromPack(AssetPack::Entry const& entry);
+    #ifndef __EMSCRIPTEN__
+    class Pool{
+    public:
+        Pool();
+        Pool(Pool const&) = delete;
+        Pool(Pool const&&) = delete;
+        Pool& operator=(Pool const&) = delete;
+        Pool& operator=(Pool const&&) = delete;
+        ~Pool();
+        void submit(std::function<void()> task);
+    private:
+        void work();
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::function<void()>> m_tasks;
+        std::vector<std::thread> m_workers;
+        bool m_stopping = false;
+    };
+    static Pool& pool();
+    #endif
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+#ifndef _FLUID_MARCHING_CUBES_TABLES_HPP_
+#define _FLUID_MARCHING_CUBES_TABLES_HPP_
+
+/* 
+    Triangulation of the level set within a single grid cell, indexed by which of the 8 corners are inside the fluid.
+    Corner i sits at offset (i & 1, (i >> 1) & 1, (i >> 2) & 1). Each row lists up to 5 triangles as triples of edge 
+    indices (see marching_cubes.geom for the edge numbering), terminated by -1. Ambiguous faces are resolved by 
+    separating the inside corners, which depends only on the face itself and so is consistent between neighbouring cells.
+    Triangle winding is not consistent - normals are taken from the level set gradient instead.
+ */
+
+unsigned int constexpr inline marchingCubesMaxTriangles = 5;
+unsigned int constexpr inline marchingCubesTableWidth = 16;
+
+int constexpr inline marchingCubesTriangleTable[] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1,
+     4, 10, 11,  4, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1,
+     8, 10, 11,  8, 11,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1, 10,  4,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1,
+     1, 11,  5,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6,  4,  1, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  1,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  9,  1,  9,  2,  1,  2,  6,  1,  6,  4, -1, -1, -1, -1,
+     2,  8,  6,  4, 10, 11,  4, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1,
+     0,  9, 11,  0, 11, 10,  0, 10,  4,  2,  8,  6, -1, -1, -1, -1,
+     2,  9, 11,  2, 11, 10,  2, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  4,  2,  4,  5,  2,  5,  7, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  1,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5,  1, 10,  4, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  2,  1,  2,  7,  1,  7,  5, -1, -1, -1, -1,
+     1, 11,  5,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1, 11,  5,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1,
+     2,  9,  7,  4, 10, 11,  4, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10, 11,  0, 11,  5,  2,  9,  7, -1, -1, -1, -1,
+     0,  2,  7,  0,  7, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1,
+     2,  8, 10,  2, 10, 11,  2, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     6,  8,  9,  6,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1,
+     4,  6,  7,  4,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4,  6,  8,  9,  6,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  7,  0,  7,  5,  1, 10,  4, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  5,  6,  8,  9,  6,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6,  4,  1, 11,  5, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1,
+     1, 11,  7,  1,  7,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1,
+     4, 10, 11,  4, 11,  5,  6,  8,  9,  6,  9,  7, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6, 10,  0, 10, 11,  0, 11,  5, -1,
+     0,  8,  6,  0,  6,  7,  0,  7, 11,  0, 11, 10,  0, 10,  4, -1,
+     6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 10,  6,  4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1,  3,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1,
+     1, 11,  5,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1, 11,  5,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  1,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  9,  1,  9,  8,  1,  8,  4,  3, 10,  6, -1, -1, -1, -1,
+     3, 11,  5,  3,  5,  4,  3,  4,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  3,  0,  3,  6,  0,  6,  4, -1, -1, -1, -1,
+     3, 11,  9,  3,  9,  8,  3,  8,  6, -1, -1, -1, -1, -1, -1, -1,
+     2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4, 10,  2, 10,  3, -1, -1, -1, -1,
+     1,  3,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1,  3,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1,
+     1,  3,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  5,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  3,  0,  3, 10,  0, 10,  4,  1, 11,  5, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  1,  2,  8, 10,  2, 10,  3, -1, -1, -1, -1,
+     1, 11,  9,  1,  9,  2,  1,  2,  3,  1,  3, 10,  1, 10,  4, -1,
+     2,  8,  4,  2,  4,  5,  2,  5, 11,  2, 11,  3, -1, -1, -1, -1,
+     0,  2,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  3,  0,  3,  2,  0,  2,  8,  0,  8,  4, -1,
+     2,  9, 11,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  7,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  2,  9,  7,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  4,  2,  4,  5,  2,  5,  7,  3, 10,  6, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  4,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3,  1,  2,  9,  7, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5,  1,  3,  6,  1,  6,  4, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  8,  1,  8,  2,  1,  2,  7,  1,  7,  5, -1,
+     1, 11,  5,  2,  9,  7,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1, 11,  5,  2,  9,  7,  3, 10,  6, -1, -1, -1, -1,
+     0,  2,  7,  0,  7, 11,  0, 11,  1,  3, 10,  6, -1, -1, -1, -1,
+     1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4,  3, 10,  6, -1,
+     2,  9,  7,  3, 11,  5,  3,  5,  4,  3,  4,  6, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5,  2,  9,  7, -1,
+     0,  2,  7,  0,  7, 11,  0, 11,  3,  0,  3,  6,  0,  6,  4, -1,
+     2,  8,  6,  2,  6,  3,  2,  3, 11,  2, 11,  7, -1, -1, -1, -1,
+     3, 10,  8,  3,  8,  9,  3,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  3,  0,  3,  7,  0,  7,  5, -1, -1, -1, -1,
+     3, 10,  4,  3,  4,  5,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  7,  1,  7,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  0,  4,  1,  0,  1,  3,  0,  3,  7,  0,  7,  5, -1,
+     1,  3,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  5,  3, 10,  8,  3,  8,  9,  3,  9,  7, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4,  1, 11,  5, -1,
+     0,  8, 10,  0, 10,  3,  0,  3,  7,  0,  7, 11,  0, 11,  1, -1,
+     1, 11,  7,  1,  7,  3,  1,  3, 10,  1, 10,  4, -1, -1, -1, -1,
+     3, 11,  5,  3,  5,  4,  3,  4,  8,  3,  8,  9,  3,  9,  7, -1,
+     0,  9,  7,  0,  7,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1,
+     0,  8,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 11,  7,  4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  1,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1, 10,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  9,  1,  9,  5,  3, 11,  7, -1, -1, -1, -1,
+     1,  3,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1,  3,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  7,  1,  7,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1,
+     3, 10,  4,  3,  4,  5,  3,  5,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  3,  0,  3,  7,  0,  7,  5, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1,
+     3, 10,  8,  3,  8,  9,  3,  9,  7, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6,  4,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4,  6,  3, 11,  7, -1, -1, -1, -1,
+     1, 10,  4,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6, 10,  0, 10,  1,  3, 11,  7, -1, -1, -1, -1,
+     0,  9,  5,  1, 10,  4,  2,  8,  6,  3, 11,  7, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5,  3, 11,  7, -1,
+     1,  3,  7,  1,  7,  5,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  6,  0,  6,  4,  1,  3,  7,  1,  7,  5, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  3,  0,  3,  1,  2,  8,  6, -1, -1, -1, -1,
+     1,  3,  7,  1,  7,  9,  1,  9,  2,  1,  2,  6,  1,  6,  4, -1,
+     2,  8,  6,  3, 10,  4,  3,  4,  5,  3,  5,  7, -1, -1, -1, -1,
+     0,  2,  6,  0,  6, 10,  0, 10,  3,  0,  3,  7,  0,  7,  5, -1,
+     0,  9,  7,  0,  7,  3,  0,  3, 10,  0, 10,  4,  2,  8,  6, -1,
+     2,  9,  7,  2,  7,  3,  2,  3, 10,  2, 10,  6, -1, -1, -1, -1,
+     2,  9, 11,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  2,  9, 11,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  4,  2,  4,  5,  2,  5, 11,  2, 11,  3, -1, -1, -1, -1,
+     1, 10,  4,  2,  9, 11,  2, 11,  3, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  1,  2,  9, 11,  2, 11,  3, -1, -1, -1, -1,
+     0,  2,  3,  0,  3, 11,  0, 11,  5,  1, 10,  4, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  2,  1,  2,  3,  1,  3, 11,  1, 11,  5, -1,
+     1,  3,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1,  3,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1,
+     0,  2,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4, 10,  2, 10,  3, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  3,  0,  3,  2,  0,  2,  9,  0,  9,  5, -1,
+     0,  2,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1,
+     2,  8, 10,  2, 10,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 11,  9,  3,  9,  8,  3,  8,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  3,  0,  3,  6,  0,  6,  4, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5, -1, -1, -1, -1,
+     3, 11,  5,  3,  5,  4,  3,  4,  6, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4,  3, 11,  9,  3,  9,  8,  3,  8,  6, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  3,  0,  3,  6,  0,  6, 10,  0, 10,  1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3, 11,  0, 11,  5,  1, 10,  4, -1,
+     1, 10,  6,  1,  6,  3,  1,  3, 11,  1, 11,  5, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1,
+     0,  9,  5,  0,  5,  1,  0,  1,  3,  0,  3,  6,  0,  6,  4, -1,
+     0,  8,  6,  0,  6,  3,  0,  3,  1, -1, -1, -1, -1, -1, -1, -1,
+     1,  3,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     3, 10,  4,  3,  4,  5,  3,  5,  9,  3,  9,  8,  3,  8,  6, -1,
+     0,  9,  5,  3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  3,  0,  3, 10,  0, 10,  4, -1, -1, -1, -1,
+     3, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     4,  8,  9,  4,  9,  5,  6, 10, 11,  6, 11,  7, -1, -1, -1, -1,
+     1, 11,  7,  1,  7,  6,  1,  6,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1,
+     0,  9,  5,  1, 11,  7,  1,  7,  6,  1,  6,  4, -1, -1, -1, -1,
+     1, 11,  7,  1,  7,  6,  1,  6,  8,  1,  8,  9,  1,  9,  5, -1,
+     1, 10,  6,  1,  6,  7,  1,  7,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  1, 10,  6,  1,  6,  7,  1,  7,  5, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  7,  1,  7,  9,  1,  9,  8,  1,  8,  4, -1,
+     4,  6,  7,  4,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1,
+     6,  8,  9,  6,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  8, 10,  2, 10, 11,  2, 11,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1,
+     0,  9,  5,  2,  8, 10,  2, 10, 11,  2, 11,  7, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4, 10,  2, 10, 11,  2, 11,  7, -1,
+     1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1,
+     0,  2,  7,  0,  7, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  1, 11,  7,  1,  7,  2,  1,  2,  8,  1,  8,  4, -1,
+     1, 11,  7,  1,  7,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  2,  1,  2,  7,  1,  7,  5, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5,  0,  5,  1,  0,  1, 10,  0, 10,  4, -1,
+     0,  9,  7,  0,  7,  2,  0,  2,  8,  0,  8, 10,  0, 10,  1, -1,
+     1, 10,  4,  2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  4,  2,  4,  5,  2,  5,  7, -1, -1, -1, -1, -1, -1, -1,
+     0,  2,  7,  0,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  7,  0,  7,  2,  0,  2,  8,  0,  8,  4, -1, -1, -1, -1,
+     2,  9,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  9, 11,  2, 11, 10,  2, 10,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  2,  9, 11,  2, 11, 10,  2, 10,  6, -1, -1, -1, -1,
+     0,  2,  6,  0,  6, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1,
+     2,  8,  4,  2,  4,  5,  2,  5, 11,  2, 11, 10,  2, 10,  6, -1,
+     1, 11,  9,  1,  9,  2,  1,  2,  6,  1,  6,  4, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  2,  0,  2,  9,  0,  9, 11,  0, 11,  1, -1,
+     0,  2,  6,  0,  6,  4,  0,  4,  1,  0,  1, 11,  0, 11,  5, -1,
+     1, 11,  5,  2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5, -1, -1, -1, -1,
+     0,  8,  4,  1, 10,  6,  1,  6,  2,  1,  2,  9,  1,  9,  5, -1,
+     0,  2,  6,  0,  6, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  6,  1,  6,  2,  1,  2,  8,  1,  8,  4, -1, -1, -1, -1,
+     2,  9,  5,  2,  5,  4,  2,  4,  6, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  6,  0,  6,  2,  0,  2,  9,  0,  9,  5, -1, -1, -1, -1,
+     0,  2,  6,  0,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     2,  8,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     8, 10, 11,  8, 11,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11, 10,  0, 10,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  8, 10,  0, 10, 11,  0, 11,  5, -1, -1, -1, -1, -1, -1, -1,
+     4, 10, 11,  4, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 11,  9,  1,  9,  8,  1,  8,  4, -1, -1, -1, -1, -1, -1, -1,
+     0,  9, 11,  0, 11,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4,  0,  4,  1,  0,  1, 11,  0, 11,  5, -1, -1, -1, -1,
+     1, 11,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  8,  1,  8,  9,  1,  9,  5, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5,  0,  5,  1,  0,  1, 10,  0, 10,  4, -1, -1, -1, -1,
+     0,  8, 10,  0, 10,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     1, 10,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     4,  8,  9,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  8,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+#endif
\ No newline at end of file
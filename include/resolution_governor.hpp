@@ -0,0 +1,35 @@
+#ifndef _FLUID_RESOLUTION_GOVERNOR_HPP_
+#define _FLUID_RESOLUTION_GOVERNOR_HPP_
+
+#include <algorithm>
+#include <cmath>
+
+/* 
+    Chooses a resolution scale for a render pass so that its GPU time stays within a fixed budget.
+    Pass cost is assumed to be proportional to pixel count (i.e. to the square of the scale). To avoid 
+    oscillating between two resolutions, the scale is only lowered once the smoothed pass time has exceeded 
+    the budget for several consecutive frames, and only raised once there has been comfortable headroom for longer.
+ */
+class ResolutionGovernor{
+    float const m_scaleIncrement = 0.05f; // Scales are quantised to avoid reallocating targets for tiny changes
+    float const m_headroomFraction = 0.75f; // Only scale up when predicted time at the next step is below this fraction of the budget
+    float const m_smoothingFactor = 0.2f;
+    unsigned int const m_framesBeforeDecrease = 8;
+    unsigned int const m_framesBeforeIncrease = 60;
+public:
+    ResolutionGovernor(float frameBudget, float minScale, float maxScale);
+    bool update(float passTime);
+    float getScale() const;
+    float getFrameBudget() const;
+private:
+    float quantiseScale(float scale) const;
+    float const m_frameBudget; // in ms
+    float const m_minScale;
+    float const m_maxScale;
+    float m_scale;
+    float m_smoothedTime;
+    unsigned int m_framesOverBudget;
+    unsigned int m_framesUnderBudget;
+};
+
+#endif
\ No newline at end of file
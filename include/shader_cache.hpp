@@ -0,0 +1,59 @@
+#ifndef _FLUID_SHADER_CACHE_HPP_
+#define _FLUID_SHADER_CACHE_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+/*
+    Caches linked shader programs on disk using program binaries (GL 4.1 / ARB_get_program_binary), so that later runs
+    skip compiling and linking. Each program is stored in its own file, named by a hash of its complete sources
+    (including any #defines they contain), its transform feedback varyings and the driver vendor, renderer and version
+    strings. A binary the driver rejects, e.g. after a driver update, is simply rebuilt from source and replaced.
+
+    The entry points are loaded by initialise(), as they are not part of the GL 3.3 core profile loaded by glad. If the
+    driver does not offer them, or supports no binary formats, the cache does nothing.
+ */
+class ShaderCache{
+    typedef void (APIENTRYP GetProgramBinaryFunction)(GLuint program, GLsizei bufferSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    typedef void (APIENTRYP ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, void const* binary, GLsizei length);
+    typedef void (APIENTRYP ProgramParameteriFunction)(GLuint program, GLenum name, GLint value);
+    static GLenum constexpr m_programBinaryRetrievableHint = 0x8257;
+    static GLenum constexpr m_programBinaryLength = 0x8741;
+    static GLenum constexpr m_numProgramBinaryFormats = 0x87FE;
+    static std::uint32_t constexpr m_fileMagic = 0x42534c46; // "FLSB"
+public:
+    ShaderCache() = delete;
+    #ifndef __EMSCRIPTEN__
+    static void initialise(GLADloadproc getProcAddress);
+    #endif
+    static void setDirectory(std::string const& directory);
+    static std::uint64_t hash(std::vector<std::string> const& parts);
+    static void prepareProgram(GLuint program);
+    static bool loadProgram(GLuint program, std::uint64_t key);
+    static void storeProgram(GLuint program, std::uint64_t key);
+    static void addBuild(bool fromCache, std::int64_t duration);
+    static void report();
+private:
+    static std::filesystem::path path(std::uint64_t key);
+    static GetProgramBinaryFunction m_getProgramBinary;
+    static ProgramBinaryFunction m_programBinary;
+    static ProgramParameteriFunction m_programParameteri;
+    static std::string m_driver; // Vendor, renderer and version
+    static std::string m_directory;
+    static unsigned int m_numLoaded, m_numCompiled;
+    static std::int64_t m_buildTime; // in us, for all programs
+};
+
+#endif
\ No newline at end of file
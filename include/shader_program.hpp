@@ -12,12 +12,35 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+
+#include "gl_state_cache.hpp"
+#include "shader_cache.hpp"
+#include "asset_pack.hpp"
 #include <vector> 
+#include <chrono>
+#include <memory>
+#include <regex>
+#include <algorithm>
+
+/*
+    Shader sources may #include "file" relative to the including file, and each file is included once per stage.
+    Each of the given defines ("NAME" or "NAME value") becomes a #define placed straight after the #version line, so the
+    compiler folds them like any other constant. Both are part of the source that keys the shader cache.
 
+    Construction only issues the compile and link: their results are first queried when the program is used, so that
+    constructing every program before using any lets the driver build them concurrently (KHR_parallel_shader_compile,
+    enabled by initialise(), or its own background compilation).
+ */
 class ShaderProgram
 {
+    typedef void (APIENTRYP MaxShaderCompilerThreadsFunction)(GLuint count);
 public:
-    ShaderProgram(const std::string vertexPath, const std::string fragmentPath);
+    #ifndef __EMSCRIPTEN__
+    static bool initialise(GLADloadproc getProcAddress);
+    #endif
+    ShaderProgram(const std::string vertexPath, const std::string fragmentPath, std::vector<std::string> const& defines = {});
+    // Optional geometry stage and transform feedback capture; fragmentPath may be empty when only capturing
+    ShaderProgram(const std::string vertexPath, const std::string geometryPath, const std::string fragmentPath, std::vector<std::string> const& feedbackVaryings = {}, std::vector<std::string> const& defines = {});
     ShaderProgram(ShaderProgram const&) = delete;
     ShaderProgram(ShaderProgram const&&) = delete;
     ShaderProgram& operator=(ShaderProgram const&) = delete;
@@ -26,9 +49,49 @@ public:
     GLuint getID() const;
     void useProgram() const;
     GLint getUniformLocation(const std::string &name) const;
+    void bindUniformBlock(const std::string &name, GLuint binding) const;
 private:
+    struct Stage{
+        GLenum shaderType;
+        std::string source;
+        std::vector<std::string> files; // Indexed by the source string numbers of the #line directives in source
+    };
+    struct PendingBuild{ // A compile and link issued but not yet checked
+        std::vector<Stage> stages;
+        std::vector<GLuint> shaderIDs; // One per stage
+        std::uint64_t key;
+        std::int64_t issueTime; // in us
+    };
     GLuint m_programID;
-    GLuint compileShader(const char *source, GLenum shaderType);
+    mutable std::unique_ptr<PendingBuild> m_pending;
+    void buildProgram(std::vector<Stage> const& stages, std::vector<std::string> const& feedbackVaryings);
+    void finishBuild() const;
+    GLuint compileShader(Stage const& stage);
+    void checkShader(GLuint shaderID, Stage const& stage) const;
+    Stage loadStage(GLenum shaderType, std::string const& path, std::vector<std::string> const& defines) const;
+    std::string expandIncludes(std::string const& path, std::vector<std::string>& files) const;
+    std::string loadSource(const std::string path) const;
+    void linkProgram(std::vector<GLuint> const& shaderIDs, std::vector<std::string> const& feedbackVaryings);
+    bool checkProgram() const;
+};
+
+/*
+    Specialisations of one shader for every combination of a set of compile-time features: variant i has each feature
+    whose bit is set in i #defined to 1, and the rest to 0. All variants are built up front (through the shader cache),
+    so choosing one at draw time is free and none of them carries the branches of the others.
+ */
+class ShaderVariants
+{
+public:
+    ShaderVariants(std::string const& vertexPath, std::string const& fragmentPath, std::vector<std::string> const& features, std::vector<std::string> const& defines = {}, std::string const& geometryPath = "");
+    ShaderVariants(ShaderVariants const&) = delete;
+    ShaderVariants(ShaderVariants const&&) = delete;
+    ShaderVariants& operator=(ShaderVariants const&) = delete;
+    ShaderVariants& operator=(ShaderVariants const&&) = delete;
+    unsigned int size() const;
+    ShaderProgram const& operator[](unsigned int variant) const;
+private:
+    std::vector<std::unique_ptr<ShaderProgram>> m_variants;
 };
   
 #endif
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef _FLUID_SLAB_PASS_GRAPH_HPP_
+#define _FLUID_SLAB_PASS_GRAPH_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "gpu_timer.hpp"
+#include "gl_state_cache.hpp"
+
+/*
+    Declarative description of a simulation step as a sequence of slab passes over 3D grid textures.
+    Each pass declares the resources it reads and produces exactly one new resource: a resource is a single version of
+    a quantity, so writing "velocity" twice gives two resources. Quantities that outlive a step (velocity, level set, ...)
+    are persistent: a step imports their current version and exports the new one.
+
+    Compiling the graph culls passes whose results never reach an export and sinks passes towards their first consumer
+    when that lowers the peak texture memory. Executing it allocates every resource a texture from a pool of grid
+    textures, each with one FBO per z-slice, so resources whose lifetimes do not overlap share a texture. The pool
+    only grows, and persistent quantities move between pool textures from step to step.
+
+    Passes that only write the interior of the grid (inner slab operations) leave the boundary texels of their result
+    holding whatever the pool texture held before. Inputs that are sampled on the boundary must therefore come from a
+    pass that writes the whole grid, or from an inner pass that writes over a resource whose boundary is defined: its
+    result takes that resource's texture, and so its boundary texels. A resource that is written over is held until
+    then, and no pass is moved past one that writes over its inputs. A graph that samples an undefined boundary fails
+    to compile, and is not executed.
+
+    Iterative passes (the Jacobi solvers) run all of their iterations in one pass, ping-ponging between their output and
+    scratch textures, so the number of iterations can change between steps without redeclaring the graph. Scratch
+    textures are either resources the pass writes over, whose boundary texels it keeps, or temporaries from the pool.
+ */
+class SlabPassGraph{
+public:
+    using Resource = int; // One version of a quantity
+    struct Texture{
+        GLuint texture;
+        std::vector<GLuint> slabFBOs; // One per z-slice
+        GLuint layeredFBO; // All z-slices, for layered draws
+    };
+    struct Input{ // Bound to the texture unit matching its position in the pass's inputs
+        Resource resource;
+        bool sampledOnBoundary; // If the pass reads boundary texels of this input
+    };
+    using Execute = std::function<void(Texture const& output, std::vector<Texture const*> const& scratch)>;
+
+    explicit SlabPassGraph(int gridSize);
+    SlabPassGraph(SlabPassGraph const&) = delete;
+    SlabPassGraph(SlabPassGraph const&&) = delete;
+    SlabPassGraph& operator=(SlabPassGraph const&) = delete;
+    SlabPassGraph& operator=(SlabPassGraph const&&) = delete;
+    ~SlabPassGraph();
+
+    int addPersistent(GLint internalFormat, std::vector<float> const& data);
+    void uploadPersistent(int quantity, std::vector<float> const& data);
+    GLuint getPersistentTexture(int quantity) const;
+
+    // Declaring a step - clear(), then import, add passes and export in execution order, then compile()
+    void clear();
+    bool isCompiled() const;
+    std::size_t getPoolBytes() const;
+    Resource importPersistent(int quantity);
+    Resource addPass(char const* name, GPUTimer* stage, std::vector<Input> const& inputs, GLint outputFormat, bool writesBoundary, Execute const& execute,
+                     std::vector<Resource> const& writesOver = {}, int numTemporaries = 0);
+    void exportPersistent(Resource resource, int quantity);
+    bool compile();
+    void execute();
+private:
+    struct PoolTexture{
+        GLint internalFormat;
+        Texture texture;
+        bool inUse;
+    };
+    struct Persistent{
+        GLint internalFormat;
+        int poolTexture;
+        bool boundaryDefined; // False if the current version came from a pass that only writes the interior
+    };
+    struct Pass{
+        char const* name;
+        GPUTimer* stage; // Timed stage the pass belongs to, if any
+        std::vector<Input> inputs;
+        Resource output;
+        bool writesBoundary;
+        std::vector<Resource> writesOver; // The output takes the texture of the first, the rest are scratch
+        int numTemporaries; // Scratch textures from the pool, of the output's format
+        Execute execute;
+    };
+    struct ResourceInfo{
+        GLint internalFormat;
+        int importedFrom; // Persistent quantity, or -1
+        int exportedTo; // Persistent quantity, or -1
+        bool boundaryDefined;
+        int lastUse; // Position in m_schedule of the last pass reading the resource
+        int writtenOverBy; // Pass whose output takes the resource's texture, or -1
+        int poolTexture;
+    };
+    static std::size_t bytesPerTexel(GLint internalFormat);
+    static GLenum pixelFormat(GLint internalFormat);
+    std::size_t peakMemory(std::vector<int> const& schedule) const;
+    bool keepsWritesOverOrder(std::vector<int> const& schedule) const;
+    void computeBoundaryDefinedness();
+    void computeLifetimes();
+    int acquireTexture(GLint internalFormat);
+    int const m_gridSize;
+    std::vector<PoolTexture> m_pool;
+    std::vector<Persistent> m_persistents;
+    std::vector<Pass> m_passes;
+    std::vector<ResourceInfo> m_resources;
+    std::vector<int> m_schedule; // Indices into m_passes, in execution order
+    bool m_compiled;
+};
+
+#endif
\ No newline at end of file
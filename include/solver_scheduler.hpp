@@ -0,0 +1,55 @@
+#ifndef _FLUID_SOLVER_SCHEDULER_HPP_
+#define _FLUID_SOLVER_SCHEDULER_HPP_
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+/* 
+    Chooses the number of Jacobi iterations used by the diffusion and pressure solvers each frame so that 
+    simulation plus rendering fits within a frame budget. Both counts are scaled together between their quality 
+    bounds, using per-iteration costs estimated from the measured GPU time of each solver loop.
+
+    With time-slicing enabled, the pressure solve may drop below its minimum when even the minimum is unaffordable.
+    The shortfall is carried over and repaid in later frames with headroom. This is valid because each pressure solve 
+    is warm-started from the previous frame's pressure, so iterations run in later frames continue the same convergence.
+    The diffusion solve restarts from the current velocity each frame, so it is never sliced.
+
+    Defining FLUID_LOG_SCHEDULER logs every change of decision, so that quality under load can be audited.
+ */
+struct SolverBounds{
+    int minIterations, maxIterations;
+};
+
+struct SolverTimings{
+    bool valid;
+    float integration, diffusion, pressure; // in ms
+};
+
+class SolverScheduler{
+    float const m_smoothingFactor = 0.2f;
+    float const m_headroomFraction = 0.9f; // Aim slightly below budget so that noise doesn't cause overruns
+    int const m_minSlicedPressureIterations = 5;
+    int const m_maxPressureIterationDebt = 200;
+    unsigned int const m_framesBeforeChange = 4; // Must exceed the lag of GPUTimer results
+public:
+    SolverScheduler(float frameBudget, SolverBounds diffusionBounds, SolverBounds pressureBounds, bool timeSlicing = true);
+    void update(SolverTimings const& solverTimings, float renderTime);
+    int getDiffusionIterations() const;
+    int getPressureIterations() const;
+    void setTimeSlicing(bool timeSlicing);
+private:
+    void logDecision(char const* reason, float availableTime) const;
+    float const m_frameBudget; // in ms
+    SolverBounds const m_diffusionBounds;
+    SolverBounds const m_pressureBounds;
+    bool m_timeSlicing;
+    int m_diffusionIterations;
+    int m_pressureIterations;
+    int m_pressureIterationDebt;
+    float m_diffusionIterationCost, m_pressureIterationCost, m_fixedCost; // Smoothed, in ms
+    unsigned int m_framesSinceChange;
+    unsigned long m_frameNumber;
+};
+
+#endif
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 #define GLM_FORCE_PURE
 #include <glm/glm.hpp>
@@ -22,7 +23,9 @@
 
 #include "texture.hpp"
 #include "shader_program.hpp"
+#include "gl_state_cache.hpp"
 
+// Strings are queued as glyph quads and drawn together with a single call by draw()
 class TextRenderer{
 public:
     TextRenderer(unsigned int w, unsigned int h);
@@ -34,13 +37,16 @@ public:
 private:
     void setUpBuffers();
     void releaseBuffers();
-    void setChar(char toDraw) const;
-    void setPosition(float scale, float xPos, float yPos) const;
+    void reserveGlyphs(std::size_t glyphCount);
+    glm::vec2 getCharOffset(char toDraw) const;
 public:
     bool successfullyInitialised() const;
-    void drawString(std::string const& toDraw, float scale, float xPos, float yPos) const;
-    void drawStringCentred(std::string const& toDraw, float scale, float xPos, float yPos) const;
+    void addString(std::string const& toDraw, float scale, float xPos, float yPos);
+    void addStringCentred(std::string const& toDraw, float scale, float xPos, float yPos);
+    void draw();
 private:
+    std::string const m_fontPath = ".//res//lucida_typewriter_font_v2.tga";
+    std::future<ImageLoader::Image> m_fontImage = ImageLoader::load(m_fontPath); // Decoded while m_shader compiles
     ShaderProgram m_shader;
     Texture m_texture;
     bool m_successfullyInitialised = false;
@@ -50,10 +56,12 @@ private:
         0.0f, 0.0f,   0.0f, 0.0f,   
         0.0f, 1.0f,   0.0f, 0.125f  
     };
-    std::vector<GLuint> const m_quadElementData {0, 1, 2, 3};
+    std::vector<GLuint> const m_quadElementData {0, 1, 2, 2, 1, 3};
+    std::vector<float> m_glyphVertexData; // Quads queued since the last draw, in screen coordinates
+    std::size_t m_glyphCapacity = 0; // Glyphs that fit in the streaming buffers
     GLuint m_VBO, m_EBO, m_VAO;
 
-    GLint m_uniformModelTrans, m_uniformProjTrans, m_uniformTextureCoordOffset;
+    GLint m_uniformProjTrans;
 };
 
 #endif
@@ -8,15 +8,17 @@
 #include "glad/glad.h"
 #endif
 
-#include "stb_image.h"
+#include "image_loader.hpp"
+#include "gl_state_cache.hpp"
 
 #include <iostream>
 #include <string>
 
 class Texture{
 public:
-    Texture(unsigned int w, unsigned int h, bool useNearest = false);
+    Texture(unsigned int w, unsigned int h, bool useNearest = false, GLint format = GL_RGB);
     Texture(std::string const& path);
+    Texture(ImageLoader::Image const& image, std::string const& path); // path only names the image in errors
     Texture(Texture const&) = delete;
     Texture(Texture const&&) = delete;
     Texture& operator=(Texture const&) = delete;
@@ -25,10 +27,15 @@ public:
     void bind() const;
     void unbind() const;
     GLuint getLocation() const;
+    GLint getWidth() const;
+    GLint getHeight() const;
     void resize(unsigned int width, unsigned int height);
+    static bool supportsBC1();
+    static GLenum constexpr compressedRGBBC1 = 0x83F0; // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
 private:
     GLuint m_texture;
     GLint m_width, m_height, m_numberOfChannels;
+    GLint m_format = GL_RGBA;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef _FLUID_TRACE_HPP_
+#define _FLUID_TRACE_HPP_
+
+#ifdef __EMSCRIPTEN__
+#include <GL/gl.h>
+#include <GLES3/gl3.h>
+#else
+#include "glad/glad.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Records a timeline of CPU spans (via TRACE_SCOPE) and GPU spans (reported by named GPUTimers) into a fixed-size
+    ring buffer, so that tracing can be left on permanently: recording a span is a clock read and a few stores, and
+    only the most recent events are kept. The ring is written out as Chrome trace-event JSON on request, which can be
+    opened in chrome://tracing or Perfetto.
+
+    GPU timestamps are on the GPU's own clock. They are mapped onto the CPU clock using an offset measured by reading
+    GL_TIMESTAMP and the CPU clock together, which is refreshed periodically to follow any drift.
+
+    Span names are not copied, so must be string literals.
+ */
+class Tracer{
+    static std::size_t constexpr m_capacity = 1 << 16; // Events, must be a power of two
+    static std::int64_t constexpr m_calibrationInterval = 1000000; // in us
+public:
+    Tracer() = delete;
+    static std::int64_t now(); // in us since the first call
+    static void addCPUSpan(char const* name, std::int64_t start, std::int64_t end);
+    static void addGPUSpan(char const* name, std::uint64_t gpuStart, std::uint64_t gpuEnd); // in ns on the GPU clock
+    static void calibrateGPUClock();
+    static void setOutputPath(std::string const& path);
+    static bool write();
+private:
+    struct Event{
+        char const* name;
+        std::int64_t start, duration; // in us
+        bool gpu;
+    };
+    static std::vector<Event> m_events;
+    static std::atomic<std::size_t> m_nextEvent;
+    static std::int64_t m_gpuClockOffset; // in ns, added to GPU timestamps to give CPU time
+    static std::int64_t m_lastCalibration;
+    static bool m_gpuClockCalibrated;
+    static std::string m_outputPath;
+};
+
+// Records the lifetime of the enclosing scope as a CPU span
+class TraceScope{
+public:
+    explicit TraceScope(char const* name);
+    TraceScope(TraceScope const&) = delete;
+    TraceScope(TraceScope const&&) = delete;
+    TraceScope& operator=(TraceScope const&) = delete;
+    TraceScope& operator=(TraceScope const&&) = delete;
+    ~TraceScope();
+private:
+    char const* const m_name;
+    std::int64_t const m_start;
+};
+
+#define TRACE_CONCATENATE_IMPL(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(traceScope, __LINE__){name}
+
+#endif
\ No newline at end of file
@@ -7,9 +7,14 @@
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#include <cstdio>
+
+#include "frame_statistics.hpp"
 
 class Window{
     Uint32 const m_windowCreationFlags = SDL_WINDOW_OPENGL;
+    unsigned int const m_titleInterval = 1000000; // in us
+    unsigned int const m_statisticsInterval = 10000000; // in us
 public:
     Window(unsigned int width, unsigned int height);
     ~Window();
@@ -21,13 +26,18 @@ public:
     SDL_Window* getWindow() const;
     void toggleFullScreen();
     void frame(unsigned int frameTime);
+    bool writeFrameStatistics(std::string const& path);
     unsigned int const m_winWidth;
     unsigned int const m_winHeight;
 private:
     SDL_Window* m_window = nullptr;
     bool m_fullScreen = false;
-    unsigned int m_timeSinceLastUpdate = 0;
-    unsigned int m_numberOfFramesSinceLastUpdate = 0;
+    FrameStatistics m_frameStatistics;
+    unsigned int m_timeSinceTitleUpdate = 0;
+    unsigned int m_framesSinceTitleUpdate = 0;
+    unsigned int m_timeSinceStatistics = 0;
+    unsigned int m_framesSinceStatistics = 0;
+    unsigned long long m_totalTime = 0; // in us
     bool m_successfullyInitialised = false;
 };
 
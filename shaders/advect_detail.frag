@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "slab.glsl"
+
+uniform sampler3D velocityTexture;
+uniform sampler3D quantityTexture; // Detail coordinates
+
+const float relaxation = 0.02f; // Pull towards the undisturbed coordinates, so the detail cannot stretch without bound
+
+void main(){
+    vec3 vel = texture(velocityTexture, lookUpCoords).xyz;
+    vec3 advected = texture(quantityTexture, lookUpCoords - vel * timeStep).xyz;
+    FragColor = vec4(mix(advected, lookUpCoords, relaxation), 1.0f);
+}
\ No newline at end of file
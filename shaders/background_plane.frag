@@ -3,6 +3,8 @@ out vec4 FragColor;
 
 in vec2 pos;
 
+#include "floor_light.glsl"
+
 const float planeSize = 10.0f;
 
 float chessBoard(vec2 coord, float cellSize){
@@ -15,4 +17,7 @@ void main()
 {
     float spotLight = min(1.0f, 1.5 - 5.0f * length(pos));
     FragColor = spotLight * vec4((vec3(chessBoard(pos + vec2(0.5f, 0.5f), 0.02f)/2.0f + 0.2f) + vec3(0.0f, 0.07f, 0.0f)), 1.0f);
+    // The plane is rotated so that its y axis points along -z
+    vec2 floorPos = vec2(pos.x, -pos.y) * planeSize / cubeScale + vec2(0.5f, 0.5f);
+    FragColor.xyz *= floorLight(vec3(floorPos.x, 1.0f / gridSize, floorPos.y));
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#version 330 core
+layout (location = 0) out vec4 EnvironmentColour; // Floor blended with the skybox, as seen by reflected rays
+layout (location = 1) out vec4 FloorColour; // Floor only, black above the horizon, as seen by refracted rays
+
+in vec2 TextureCoord;
+
+uniform samplerCube skyBoxTexture;
+uniform int face; // GL_TEXTURE_CUBE_MAP_POSITIVE_X + face is being rendered
+
+#include "scene.glsl"
+
+const float planeSize = 10.0f;
+const float floorHeight = (-0.5f + 1.0f / gridSize) * cubeScale; // The probe sits at the centre of the tank
+
+////////////////
+//floor colour functions
+float chessBoard(vec2 coord, float cellSize){
+    return float((int(floor(coord.x / cellSize)) + int(floor(coord.y / cellSize))) % 2);
+}
+
+vec4 getFloorColor(vec3 floorPos){
+    vec2 pos = vec2(floorPos.x, -floorPos.z);
+    float spotLight = min(1.0f, 1.5 - 5.0f * length(pos));
+    spotLight = max(0, spotLight);
+    return spotLight * vec4((vec3(chessBoard(pos + vec2(0.5f, 0.5f), 0.02f)/2.0f + 0.2f) + vec3(0.0f, 0.07f, 0.0f)), 1.0f);
+}
+////////////
+
+// Direction through a texel of a cube map face, following the face orientations in the GL specification
+vec3 faceDirection(vec2 st){
+    vec2 uv = 2.0f * st - 1.0f;
+    switch (face){
+        case 0: return vec3(1.0f, -uv.y, -uv.x);
+        case 1: return vec3(-1.0f, -uv.y, uv.x);
+        case 2: return vec3(uv.x, 1.0f, uv.y);
+        case 3: return vec3(uv.x, -1.0f, -uv.y);
+        case 4: return vec3(uv.x, -uv.y, 1.0f);
+        default: return vec3(-uv.x, -uv.y, -1.0f);
+    }
+}
+
+void main()
+{
+    vec3 dir = normalize(faceDirection(TextureCoord));
+    vec4 skyColour = texture(skyBoxTexture, dir);
+    if (dir.y >= 0.0f){ // Ray pointing up
+        EnvironmentColour = skyColour;
+        FloorColour = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    else{ // Ray pointing down
+        vec3 floorPos = (floorHeight / dir.y) * dir;
+        FloorColour = getFloorColor(floorPos / planeSize);
+        // Blend bg plane with skybox
+        EnvironmentColour = vec4(FloorColour.w * FloorColour.xyz + (1 - FloorColour.w) * skyColour.xyz, FloorColour.w);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "slab.glsl"
+
+uniform sampler3D quantityTexture;
+
+// BOUNDARY_MODE is defined by the application as one of these
+#define BOUNDARY_COPY 0 // Zero gradient across the boundary (pressure)
+#define BOUNDARY_NEGATE 1 // No slip (velocity)
+#define BOUNDARY_OUTSIDE 2 // Zero gradient, but boundary cells are never inside the fluid (level set)
+
+void main(){
+    // Boundary cells copy their neighbour along the first boundary axis found, so cells on the edges and corners
+    // copy another boundary cell
+    vec3 offset = vec3(0.0f, 0.0f, 0.0f);
+    if (TextureCoord.x < step){
+        offset = vec3(step, 0.0f, 0.0f);
+    }
+    else if (TextureCoord.x > 1 - step){
+        offset = vec3(-step, 0.0f, 0.0f);
+    }
+    else if (TextureCoord.y < step){
+        offset = vec3(0.0f, step, 0.0f);
+    }
+    else if (TextureCoord.y > 1 - step){
+        offset = vec3(0.0f, -step, 0.0f);
+    }
+    else if (zSlice == 0){
+        offset = vec3(0.0f, 0.0f, step);
+    }
+    else if (zSlice == gridSize - 1){
+        offset = vec3(0.0f, 0.0f, -step);
+    }
+    bool boundary = offset != vec3(0.0f, 0.0f, 0.0f);
+
+    FragColor = texture(quantityTexture, lookUpCoords + offset);
+    #if BOUNDARY_MODE == BOUNDARY_NEGATE
+    if (boundary){
+        FragColor = -FragColor;
+    }
+    #elif BOUNDARY_MODE == BOUNDARY_OUTSIDE
+    if (boundary && FragColor.x <= 0){
+        FragColor.x *= -1.0f;
+    }
+    #endif
+}
\ No newline at end of file
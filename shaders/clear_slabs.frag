@@ -1,12 +1,9 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TextureCoord;
-
-uniform float timeStep; // in microseconds
-uniform float zSlice;
+#include "slab.glsl"
 
 void main(){
-    timeStep;zSlice;
+    zSlice;
     FragColor = vec4 (0.0f, 0.0f, 0.0f, 0.0f);
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TextureCoord;
+
+uniform sampler2D fluidTexture; // Premultiplied by alpha
+
+void main()
+{
+    FragColor = texture(fluidTexture, TextureCoord);
+}
\ No newline at end of file
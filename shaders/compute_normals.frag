@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor; // Surface normal, remapped to [0, 1]
+
+#include "level_set.glsl" // levelSetTexture is the upsampled render level set
+
+#include "slice.glsl"
+
+
+void main()
+{
+    // Central differences
+    ivec3 voxel = ivec3(ivec2(gl_FragCoord.xy), int(zSlice));
+    vec3 gradient = vec3(fetchLevelSet(voxel + ivec3(1, 0, 0)) - fetchLevelSet(voxel - ivec3(1, 0, 0)),
+                         fetchLevelSet(voxel + ivec3(0, 1, 0)) - fetchLevelSet(voxel - ivec3(0, 1, 0)),
+                         fetchLevelSet(voxel + ivec3(0, 0, 1)) - fetchLevelSet(voxel - ivec3(0, 0, 1)));
+    vec3 normal = length(gradient) > 0.0f ? normalize(gradient) : vec3(0.0f, 1.0f, 0.0f);
+    FragColor = vec4(0.5f * normal + 0.5f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#version 330 core
+out vec4 FragColor; // 1 if the surface may pass through the brick, else 0
+
+#include "level_set.glsl" // levelSetTexture is the upsampled render level set
+
+#include "slice.glsl"
+
+const int brickSize = 4; // Render voxels along each side of an occupancy brick
+
+void main()
+{
+    // Every trilinear cell overlapping the brick has its corners within one voxel of it
+    ivec3 origin = brickSize * ivec3(ivec2(gl_FragCoord.xy), int(zSlice));
+    float minValue = 1.0f;
+    float maxValue = -1.0f;
+    for (int z = -1 ; z <= brickSize ; ++z){
+        for (int y = -1 ; y <= brickSize ; ++y){
+            for (int x = -1 ; x <= brickSize ; ++x){
+                float value = fetchLevelSet(origin + ivec3(x, y, z));
+                minValue = min(minValue, value);
+                maxValue = max(maxValue, value);
+            }
+        }
+    }
+    FragColor = vec4(float(minValue < 0.0f && maxValue >= 0.0f), 0.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 330 core
+out vec4 FragColor; // (transmittance, caustic factor / 2)
+
+in vec2 TextureCoord;
+
+#include "level_set.glsl" // levelSetTexture is the upsampled render level set
+
+#include "slice.glsl"
+
+// gridSize is also the resolution of the transmittance volume
+const float step = 1.0f/(2 * renderGridSize);
+const float absorption = 2.0f; // Per cube side length travelled through water
+const float levelSetBand = 4.0f; // As in encode_level_set.frag, in simulation voxels
+const float causticStrength = 2.0f;
+
+// Light is focused below convex crests and spread below troughs - estimated from the mean curvature of the surface
+float causticAtPoint(vec3 pt){
+    const float h = 1.0f / renderGridSize;
+    float laplacian = sampleLevelSet(pt + vec3(h, 0.0f, 0.0f)) + sampleLevelSet(pt - vec3(h, 0.0f, 0.0f)) +
+                      sampleLevelSet(pt + vec3(0.0f, h, 0.0f)) + sampleLevelSet(pt - vec3(0.0f, h, 0.0f)) +
+                      sampleLevelSet(pt + vec3(0.0f, 0.0f, h)) + sampleLevelSet(pt - vec3(0.0f, 0.0f, h)) -
+                      6.0f * sampleLevelSet(pt);
+    // Render voxels are half a simulation voxel across
+    float meanCurvature = 0.5f * laplacian * levelSetBand / 0.25f;
+    return clamp(1.0f + causticStrength * meanCurvature, 0.25f, 2.0f);
+}
+
+void main(){
+    vec3 pt = vec3(TextureCoord, (zSlice + 0.5f) / gridSize);
+
+    // March towards the light, accumulating the distance travelled through water
+    float waterLength = 0.0f;
+    float caustic = 1.0f;
+    bool wasInside = sampleLevelSet(pt) < 0.0f;
+    for (int i = 0 ; i < 4 * renderGridSize ; ++i){
+        pt += step * lightDir;
+        if (any(greaterThan(pt, vec3(1.0f, 1.0f, 1.0f)))){
+            break;
+        }
+        bool inside = sampleLevelSet(pt) < 0.0f;
+        if (inside){
+            waterLength += step;
+        }
+        else if (wasInside){
+            // The last surface crossed is the one the light refracts through first
+            caustic = causticAtPoint(pt);
+        }
+        wasInside = inside;
+    }
+
+    FragColor = vec4(exp(-absorption * waterLength), 0.5f * caustic, 0.0f, 1.0f);
+}
\ No newline at end of file
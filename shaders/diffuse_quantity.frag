@@ -1,18 +1,10 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TextureCoord;
+#include "slab.glsl"
 
 uniform sampler3D quantityTexture;
 
-uniform float timeStep; // in microseconds
-uniform float zSlice;
-
-const int gridSize = 32;
-const float step = 1.0f/gridSize;
-
-vec3 lookUpCoords = vec3(TextureCoord, zSlice * step + 0.5f * step);
-
 const float viscosity = 1e-5;//1e-3; // Currently like honey! Needs to be lower for water
 
 vec4 diffuseQuantity(){
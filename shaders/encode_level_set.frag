@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "slab.glsl"
+
+uniform sampler3D levelSetTexture;
+
+const float levelSetBand = 4.0f; // Half-width of the narrow band kept for rendering, in voxels
+
+void main(){
+    float levelSet = texture(levelSetTexture, lookUpCoords).x;
+    // Clamp to the narrow band and remap from [-1, 1] to the [0, 1] range of the unsigned normalised target
+    FragColor = vec4(clamp(levelSet / levelSetBand, -1.0f, 1.0f) * 0.5f + 0.5f);
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+// Shading of secondary rays from the static environment probes baked by bake_environment.frag
+#include "floor_light.glsl"
+
+uniform samplerCube environmentTexture;
+uniform samplerCube floorEnvironmentTexture;
+
+// The probes are centred on the tank, at the origin of world space. Rays pointing down look up the point where they hit
+// the floor, so the floor is seen without parallax error from anywhere in the tank
+vec3 probeDirection(vec3 startPoint, vec3 dir, out vec3 floorPoint){
+    float lambda = (-startPoint.y + 1.0f / gridSize) * cubeScale / dir.y;
+    vec3 floorPos = (startPoint - vec3(0.5f, 0.5f, 0.5f)) * cubeScale + lambda * dir;
+    floorPoint = floorPos / cubeScale + vec3(0.5f, 0.5f, 0.5f);
+    return dir.y < 0.0f ? floorPos : dir;
+}
+
+vec4 rayColour(vec3 startPoint, vec3 dir){
+    vec3 floorPoint;
+    vec4 outColour = texture(environmentTexture, probeDirection(startPoint, dir, floorPoint));
+    outColour.xyz *= dir.y < 0.0f ? floorLight(floorPoint) : 1.0f;
+    return outColour;
+}
+
+vec4 rayColourBlack(vec3 startPoint, vec3 dir){
+    vec3 floorPoint;
+    vec4 outColour = texture(floorEnvironmentTexture, probeDirection(startPoint, dir, floorPoint));
+    outColour.xyz *= dir.y < 0.0f ? floorLight(floorPoint) : 1.0f;
+    return outColour;
+}
\ No newline at end of file
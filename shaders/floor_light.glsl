@@ -0,0 +1,17 @@
+// Lighting of the floor below the tank, shadowed and focused by the fluid
+#include "scene.glsl"
+
+uniform sampler3D transmittanceTexture;
+
+// Light reaching a point on the floor (in cube texture coordinates), looked up where the light ray enters the cube
+float floorLight(vec3 floorPoint){
+    vec3 t0 = (vec3(0.0f, 0.0f, 0.0f) - floorPoint) / lightDir;
+    vec3 t1 = (vec3(1.0f, 1.0f, 1.0f) - floorPoint) / lightDir;
+    float entry = max(max(min(t0.x, t1.x), min(t0.y, t1.y)), min(t0.z, t1.z));
+    float exit = min(min(max(t0.x, t1.x), max(t0.y, t1.y)), max(t0.z, t1.z));
+    if (exit < max(entry, 0.0f)){
+        return 1.0f; // Light does not pass through the cube
+    }
+    vec2 light = texture(transmittanceTexture, floorPoint + max(entry, 0.0f) * lightDir).xy;
+    return light.x * 2.0f * light.y;
+}
\ No newline at end of file
@@ -7,33 +7,149 @@ in vec2 TextureCoord;
 uniform sampler2D frontTexture;
 uniform sampler2D backTexture;
 
-uniform sampler3D levelSetTexture;
 uniform sampler1D splineTexture;
 uniform sampler1D splineDerivTexture;
-uniform samplerCube skyBoxTexture;
-uniform bool tricubicNormals = true;
 
+#include "level_set.glsl"
+#include "environment.glsl"
+
+// Defined by the renderer, which builds a variant of this shader for each setting of CELL_TRAVERSAL
+const bool tricubicNormals = bool(TRICUBIC_NORMALS);
+const bool cellTraversal = bool(CELL_TRAVERSAL); // Walk the trilinear cells exactly instead of stepping at half voxel intervals
 
-const int gridSize = 32;
-const float planeSize = 10.0f;
-const float cubeScale = 1.5f;
 const vec4 sampleColour = vec4(0.227f, 0.621f, 0.777f, 0.8f) * vec4(1.0f, 1.0f, 1.0f, 1.5f/gridSize); // Vivid pale blue, with alpha factor
 
 const vec4 skyColour = vec4(0.0f, 0.0f, 0.0f, 1.0f);
 
-const float step = 1.0f/(2 * gridSize); // Half voxel size
+const float step = 1.0f/(2 * renderGridSize); // Half render voxel size
+const float surfaceBand = 0.5f; // Cells whose entry value is further from zero cannot contain the surface (allows for drift from a distance field)
 
 ////////////////
-//floor colour functions
-float chessBoard(vec2 coord, float cellSize){
-    return (( int(floor(coord.x / cellSize)) + int(floor(coord.y / cellSize)) ) % 2);
+//cell traversal functions
+// Coefficients (t^3, t^2, t, 1) of the trilinear interpolant in a cell along a ray, from a local origin in [0, 1]^3
+vec4 cellCubic(ivec3 cell, vec3 origin, vec3 dir){
+    vec4 coefficients = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 0 ; i < 8 ; ++i){
+        vec3 corner = vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1);
+        // Each interpolation weight is linear along the ray: a + b * t
+        vec3 a = mix(1.0f - origin, origin, corner);
+        vec3 b = mix(-dir, dir, corner);
+        coefficients += fetchLevelSet(cell + ivec3(corner)) * vec4(b.x * b.y * b.z,
+                                                                  a.x * b.y * b.z + b.x * a.y * b.z + b.x * b.y * a.z,
+                                                                  b.x * a.y * a.z + a.x * b.y * a.z + a.x * a.y * b.z,
+                                                                  a.x * a.y * a.z);
+    }
+    return coefficients;
+}
+
+float evaluateCubic(vec4 coefficients, float t){
+    return ((coefficients.x * t + coefficients.y) * t + coefficients.z) * t + coefficients.w;
+}
+
+// First t in [0, len] at which the inside/outside state of the cubic changes, refined by regula falsi
+bool firstRoot(vec4 coefficients, float len, bool inside, out float root){
+    float a = 0.0f;
+    float fa = evaluateCubic(coefficients, a);
+    if ((fa < 0.0f) != inside){
+        root = 0.0f;
+        return true;
+    }
+    // Split at the extrema, so the cubic is monotonic on each interval
+    float bounds[3] = float[3](len, len, len);
+    float qa = 3.0f * coefficients.x, qb = 2.0f * coefficients.y, qc = coefficients.z;
+    if (abs(qa) > 1e-8f){
+        float discriminant = qb * qb - 4.0f * qa * qc;
+        if (discriminant >= 0.0f){
+            vec2 extrema = (vec2(-qb) + vec2(-1.0f, 1.0f) * sqrt(discriminant)) / (2.0f * qa);
+            bounds[0] = clamp(min(extrema.x, extrema.y), 0.0f, len);
+            bounds[1] = clamp(max(extrema.x, extrema.y), 0.0f, len);
+        }
+    }
+    else if (abs(qb) > 1e-8f){
+        bounds[0] = clamp(-qc / qb, 0.0f, len);
+    }
+    for (int i = 0 ; i < 3 ; ++i){
+        float b = bounds[i];
+        float fb = evaluateCubic(coefficients, b);
+        if ((fb < 0.0f) != inside){
+            const int numberOfRefinements = 4;
+            for (int j = 0 ; j < numberOfRefinements ; ++j){
+                float m = a - fa * (b - a) / (fb - fa);
+                float fm = evaluateCubic(coefficients, m);
+                if ((fm < 0.0f) == inside){
+                    a = m;
+                    fa = fm;
+                }
+                else{
+                    b = m;
+                    fb = fm;
+                }
+            }
+            root = a - fa * (b - a) / (fb - fa);
+            return true;
+        }
+        a = b;
+        fa = fb;
+    }
+    return false;
+}
+
+// Walks the trilinear cells (spanning neighbouring voxel centres) crossed by a ray using a 3D-DDA, returning the
+// distance to the first point where the ray leaves (inside) or enters (!inside) the fluid. Cells away from the surface
+// cost a single fetch; the eight corners are only fetched where the surface may pass through the cell
+bool traverseCells(vec3 start, vec3 dir, float maxLength, bool inside, out float hitLength){
+    vec3 cellPos = start * renderGridSize - vec3(0.5f, 0.5f, 0.5f);
+    vec3 cellDir = dir * renderGridSize;
+    ivec3 cell = ivec3(floor(cellPos));
+    ivec3 cellStep = ivec3(sign(cellDir));
+    vec3 tDelta = 1.0f / max(abs(cellDir), vec3(1e-6f));
+    vec3 tMax = mix(cellPos - vec3(cell), vec3(cell) + 1.0f - cellPos, vec3(greaterThan(cellDir, vec3(0.0f)))) * tDelta;
+
+    float tEntry = 0.0f;
+    float entryValue = sampleLevelSet(start);
+    for (int i = 0 ; i < 3 * renderGridSize + 3 && tEntry < maxLength ; ++i){
+        float tExit = min(min(tMax.x, tMax.y), min(tMax.z, maxLength));
+        float exitValue;
+        if (abs(entryValue) < surfaceBand){
+            vec4 coefficients = cellCubic(cell, cellPos + tEntry * cellDir - vec3(cell), cellDir);
+            float root;
+            if (firstRoot(coefficients, tExit - tEntry, inside, root)){
+                hitLength = tEntry + root;
+                return true;
+            }
+            exitValue = evaluateCubic(coefficients, tExit - tEntry);
+        }
+        else{
+            exitValue = sampleLevelSet(start + tExit * dir);
+            if ((exitValue < 0.0f) != inside){
+                hitLength = tExit;
+                return true;
+            }
+        }
+        // Step into the neighbouring cell
+        entryValue = exitValue;
+        tEntry = tExit;
+        if (tMax.x <= tMax.y && tMax.x <= tMax.z){
+            cell.x += cellStep.x;
+            tMax.x += tDelta.x;
+        }
+        else if (tMax.y <= tMax.z){
+            cell.y += cellStep.y;
+            tMax.y += tDelta.y;
+        }
+        else{
+            cell.z += cellStep.z;
+            tMax.z += tDelta.z;
+        }
+    }
+    hitLength = maxLength;
+    return false;
 }
 
-vec4 getFloorColor(vec3 floorPos){
-    vec2 pos = vec2(floorPos.x, -floorPos.z);
-    float spotLight = min(1.0f, 1.5 - 5.0f * length(pos));
-    spotLight = max(0, spotLight);
-    return spotLight * vec4((vec3(chessBoard(pos + vec2(0.5f, 0.5f), 0.02f)/2.0f + 0.2f) + vec3(0.0f, 0.07f, 0.0f)), 1.0f);// + /*vec4(0.5f, 0.5f, 0.5f, 1.0f)*/ skyColour * (1-spotLight) ;
+// Distance along a ray starting inside the cube to where it leaves
+float distanceToCubeExit(vec3 start, vec3 dir){
+    vec3 t = mix(vec3(1.0f) - start, start, vec3(lessThan(dir, vec3(0.0f)))) / max(abs(dir), vec3(1e-6f));
+    return min(min(t.x, t.y), t.z);
 }
 ////////////
 
@@ -52,97 +168,65 @@ vec3 normalAtPoint(vec3 pt, float sample /*so not sampled redundantly*/){
         const vec3 e_y = vec3(0.0f, dX, 0.0f);
         const vec3 e_z = vec3(0.0f, 0.0f, dX);  
         float levelSetCentre = sample;
-        float levelSetPosX = float(texture(levelSetTexture, pt + e_x).x);
-        float levelSetNegX = float(texture(levelSetTexture, pt - e_x).x);
-        float levelSetPosY = float(texture(levelSetTexture, pt + e_y).x);
-        float levelSetNegY = float(texture(levelSetTexture, pt - e_y).x);
-        float levelSetPosZ = float(texture(levelSetTexture, pt + e_z).x);
-        float levelSetNegZ = float(texture(levelSetTexture, pt - e_z).x);
+        float levelSetPosX = sampleLevelSet(pt + e_x);
+        float levelSetNegX = sampleLevelSet(pt - e_x);
+        float levelSetPosY = sampleLevelSet(pt + e_y);
+        float levelSetNegY = sampleLevelSet(pt - e_y);
+        float levelSetPosZ = sampleLevelSet(pt + e_z);
+        float levelSetNegZ = sampleLevelSet(pt - e_z);
 
         surfaceNormal = vec3(levelSetPosX - levelSetNegX, levelSetPosY - levelSetNegY, levelSetPosZ - levelSetNegZ) / (2 * dX);
     }
     else{
         // Tricubic interpolation
 
-        vec3 splineCoords = pt * float(gridSize) - vec3(0.5f, 0.5f, 0.5f);
+        vec3 splineCoords = pt * float(renderGridSize) - vec3(0.5f, 0.5f, 0.5f);
 
 
 
-        vec4 ghX = texture(splineDerivTexture, splineCoords.x)/gridSize;
-        vec4 ghY = texture(splineTexture, splineCoords.y)/gridSize;
-        vec4 ghZ = texture(splineTexture, splineCoords.z)/gridSize;
+        vec4 ghX = texture(splineDerivTexture, splineCoords.x)/renderGridSize;
+        vec4 ghY = texture(splineTexture, splineCoords.y)/renderGridSize;
+        vec4 ghZ = texture(splineTexture, splineCoords.z)/renderGridSize;
         
         // ghX = (g0(x), g1(x), -h0(x), h1(x))
-        surfaceNormal.x = ghZ.x * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.z)).x + 
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.z)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.z)).x  +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.z)).x)) +
-                            ghZ.y * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.w)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.w)).x)); 
-
-        ghX = texture(splineTexture, splineCoords.x)/gridSize;
-        ghY = texture(splineDerivTexture, splineCoords.y)/gridSize;                        
-
-        surfaceNormal.y = ghZ.x * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.z)).x + 
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.z)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.z)).x  +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.z)).x)) +
-                            ghZ.y * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.w)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.w)).x)); 
-
-        ghY = texture(splineTexture, splineCoords.y)/gridSize;
-        ghZ = texture(splineDerivTexture, splineCoords.z)/gridSize;                        
-
-        surfaceNormal.z = ghZ.x * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.z)).x + 
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.z)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.z)).x  +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.z)).x)) +
-                            ghZ.y * (ghY.x * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.z, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.z, ghZ.w)).x) +
-                                    ghY.y * (ghX.x * texture(levelSetTexture, pt + vec3(ghX.z, ghY.w, ghZ.w)).x +
-                                            ghX.y * texture(levelSetTexture, pt + vec3(ghX.w, ghY.w, ghZ.w)).x)); 
+        surfaceNormal.x = ghZ.x * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.z)) + 
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.z))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.z))  +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.z)))) +
+                            ghZ.y * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.w))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.w)))); 
+
+        ghX = texture(splineTexture, splineCoords.x)/renderGridSize;
+        ghY = texture(splineDerivTexture, splineCoords.y)/renderGridSize;                        
+
+        surfaceNormal.y = ghZ.x * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.z)) + 
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.z))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.z))  +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.z)))) +
+                            ghZ.y * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.w))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.w)))); 
+
+        ghY = texture(splineTexture, splineCoords.y)/renderGridSize;
+        ghZ = texture(splineDerivTexture, splineCoords.z)/renderGridSize;                        
+
+        surfaceNormal.z = ghZ.x * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.z)) + 
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.z))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.z))  +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.z)))) +
+                            ghZ.y * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.w))) +
+                                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.w)) +
+                                            ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.w)))); 
 
                             // Issue: ghN.x and .y have redundancy
     }
     return normalize(surfaceNormal);
 }
 
-vec4 rayColour(vec3 startPoint, vec3 dir){
-    vec4 outColour;
-    if (dir.y >= 0.0f){ // Ray pointing up
-        outColour =  texture(skyBoxTexture, dir);
-    }
-    else{ // Ray pointing down
-        float lambda = (-startPoint.y + 2 * step) * cubeScale;
-        lambda /= dir.y;
-        vec3 floorPos = (startPoint - vec3(0.5f, 0.5f, 0.5f)) * cubeScale + lambda * dir; 
-        outColour = getFloorColor(floorPos / ( planeSize));
-        // Blend bg plane with skybox
-        outColour.xyz = outColour.w * outColour.xyz + (1 - outColour.w) * texture(skyBoxTexture, dir).xyz;
-    }
-    return outColour;
-}
-
-vec4 rayColourBlack(vec3 startPoint, vec3 dir){
-    vec4 outColour;
-    if (dir.y >= 0.0f){ // Ray pointing up
-        outColour =  vec4(0.0f, 0.0f, 0.0f, 0.0f);
-    }
-    else{ // Ray pointing down
-        float lambda = (-startPoint.y + 2 * step) * cubeScale;
-        lambda /= dir.y;
-        vec3 floorPos = (startPoint - vec3(0.5f, 0.5f, 0.5f)) * cubeScale + lambda * dir; 
-        outColour = getFloorColor(floorPos / ( planeSize));
-        // Blend bg plane with skybox
-        //outColour.xyz = outColour.w * outColour.xyz + (1 - outColour.w) * texture(skyBoxTexture, dir).xyz;
-    }
-    return outColour;
-}
-
 void main()
 {
     // Consider using subtractive blending instead
@@ -188,63 +272,78 @@ void main()
 
     const float refIndex = 1.33;
 
-    for (marchingDistance = 0.0f ; marchingDistance < 2.0f * len ; marchingDistance += step, marchingPoint += step * tempDir){
-        /* if (finalColour.w > 0.99f)
-            break; */
+    if (cellTraversal){
+        float hitLength;
+        reachedSurface = traverseCells(marchingPoint, dir, len, false, hitLength);
+        if (reachedSurface){
+            surfacePoint = marchingPoint + hitLength * dir;
+            surfaceNormal = normalAtPoint(surfacePoint, 0.0f);
+            refractDir = normalize(refract(dir, surfaceNormal, 1.0f/refIndex));
+            // Start just inside the surface, so the hit itself is not found again
+            vec3 refractStart = surfacePoint + 0.05f * step * refractDir;
+            exited = traverseCells(refractStart, refractDir, distanceToCubeExit(refractStart, refractDir), true, hitLength);
+            exitPoint = refractStart + hitLength * refractDir;
+            exitNormal = normalAtPoint(exitPoint, 0.0f);
+        }
+    }
+    else{
+        for (marchingDistance = 0.0f ; marchingDistance < 2.0f * len ; marchingDistance += step, marchingPoint += step * tempDir){
+            /* if (finalColour.w > 0.99f)
+                break; */
         
-        float sample = float(texture(levelSetTexture, marchingPoint).x);
-
-        if (sample < 0.0f){
-            if (!reachedSurface){
-                // FragColor = vec4(-1.0f/sample, 0.0f, 0.0f, 1.0f); return;
-                reachedSurface  = true;
-                // Hitpoint refinement
-                const int numberOfRefinements = 6;
-                for (int i = 1 ; i <= numberOfRefinements; ++i){
-                    if (sample < 0){
-                        marchingPoint -= pow(0.5f, i) * step * tempDir;
+            float sample = sampleLevelSet(marchingPoint);
+
+            if (sample < 0.0f){
+                if (!reachedSurface){
+                    // FragColor = vec4(-1.0f/sample, 0.0f, 0.0f, 1.0f); return;
+                    reachedSurface  = true;
+                    // Hitpoint refinement
+                    const int numberOfRefinements = 6;
+                    for (int i = 1 ; i <= numberOfRefinements; ++i){
+                        if (sample < 0){
+                            marchingPoint -= pow(0.5f, i) * step * tempDir;
+                        }
+                        else{
+                            marchingPoint += pow(0.5f, i) * step * tempDir;
+                        }
+                        sample = sampleLevelSet(marchingPoint);
                     }
-                    else{
-                        marchingPoint += pow(0.5f, i) * step * tempDir;
-                    }
-                    sample = float(texture(levelSetTexture, marchingPoint).x);
+                    // Normals
+                    surfacePoint = marchingPoint;
+                    surfaceNormal = normalAtPoint(marchingPoint, sample);
+                    refractDir = refract(dir,surfaceNormal, 1.0f/refIndex);
+                    refractDir = normalize(refractDir); 
+                    tempDir = refractDir; 
                 }
-                // Normals
-                surfacePoint = marchingPoint;
-                surfaceNormal = normalAtPoint(marchingPoint, sample);
-                refractDir = refract(dir,surfaceNormal, 1.0f/refIndex);
-                refractDir = normalize(refractDir); 
-                tempDir = refractDir; 
+                //finalColour.xyz += sampleColour.xyz * sampleColour.w * (1.0f - finalColour.w);
+                //finalColour.w += sampleColour.w * (1.0f - finalColour.w);
             }
-            //finalColour.xyz += sampleColour.xyz * sampleColour.w * (1.0f - finalColour.w);
-            //finalColour.w += sampleColour.w * (1.0f - finalColour.w);
-        }
-        else{
-            if (reachedSurface){
-                exited = true;
-                // Hitpoint refinement
-                const int numberOfRefinements = 6;
-                for (int i = 1 ; i <= numberOfRefinements; ++i){
-                    if (sample > 0){
-                        marchingPoint -= pow(0.5f, i) * step * tempDir;
-                    }
-                    else{
-                        marchingPoint += pow(0.5f, i) * step * tempDir;
-                    }
-                    sample = float(texture(levelSetTexture, marchingPoint).x);
-                }                
-                exitPoint = marchingPoint;
-                exitNormal = normalAtPoint(marchingPoint, sample);
-                break;
+            else{
+                if (reachedSurface){
+                    exited = true;
+                    // Hitpoint refinement
+                    const int numberOfRefinements = 6;
+                    for (int i = 1 ; i <= numberOfRefinements; ++i){
+                        if (sample > 0){
+                            marchingPoint -= pow(0.5f, i) * step * tempDir;
+                        }
+                        else{
+                            marchingPoint += pow(0.5f, i) * step * tempDir;
+                        }
+                        sample = sampleLevelSet(marchingPoint);
+                    }                
+                    exitPoint = marchingPoint;
+                    exitNormal = normalAtPoint(marchingPoint, sample);
+                    break;
+                }
             }
-        }
         
         
+        }
     }
 
     vec3 lightColour = vec3(1.0f, 1.0f, 1.0f);
     float ambientStrength = 0.5f;
-    vec3 lightDir = normalize(vec3(1.0f, 2.0f, 1.0f));
 
     vec3 diffuseColour = max(dot(surfaceNormal, lightDir), 0.0f) * lightColour * 2.0f;
     vec3 ambientColour = lightColour * ambientStrength;
@@ -261,7 +360,7 @@ void main()
     float k = 1.0f - refIndex * refIndex * (1.0f - dot(exitNormal, refractDir) * dot(exitNormal, refractDir));
     
     if (k < 0.0f){// TIR
-        if (exitPoint.y < 3.0f * step){
+        if (exitPoint.y < 1.5f / gridSize){
             //  no op
         }
         else{
@@ -1,4 +1,5 @@
 #version 330 core
+#include "slice_vertex.glsl"
 layout (location = 0) in vec2 position;
 layout (location = 1 ) in vec2 textureCoord;
 
@@ -13,4 +14,5 @@ void main()
 {
     gl_Position = projection * model * vec4(position, 0.0f, 1.0);
     TextureCoord = textureCoord;
+    setSlice();
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 SurfacePoint;
+in vec3 SurfaceNormal;
+
+uniform vec3 cameraPosition; // In level set texture coordinates
+
+#include "level_set.glsl"
+#include "environment.glsl"
+
+const float step = 1.0f/(2 * renderGridSize); // Half render voxel size
+
+vec3 normalAtPoint(vec3 pt){
+    // Central differences
+    const float dX = 2 * step;
+    const vec3 e_x = vec3(dX, 0.0f, 0.0f);
+    const vec3 e_y = vec3(0.0f, dX, 0.0f);
+    const vec3 e_z = vec3(0.0f, 0.0f, dX);
+    return normalize(vec3(sampleLevelSet(pt + e_x) - sampleLevelSet(pt - e_x),
+                          sampleLevelSet(pt + e_y) - sampleLevelSet(pt - e_y),
+                          sampleLevelSet(pt + e_z) - sampleLevelSet(pt - e_z)));
+}
+
+void main()
+{
+    // Primary visibility comes from the rasterised mesh, so only the refracted ray is marched
+    vec3 dir = normalize(SurfacePoint - cameraPosition);
+    vec3 surfaceNormal = normalize(SurfaceNormal);
+
+    const float refIndex = 1.33;
+    vec3 refractDir = normalize(refract(dir, surfaceNormal, 1.0f/refIndex));
+
+    vec3 marchingPoint = SurfacePoint + step * refractDir;
+    vec3 exitPoint = marchingPoint;
+    for (float marchingDistance = 0.0f ; marchingDistance < 2.0f ; marchingDistance += step, marchingPoint += step * refractDir){
+        float sample = sampleLevelSet(marchingPoint);
+        if (sample >= 0.0f || any(lessThan(marchingPoint, vec3(0.0f))) || any(greaterThan(marchingPoint, vec3(1.0f)))){
+            // Hitpoint refinement
+            const int numberOfRefinements = 6;
+            for (int i = 1 ; i <= numberOfRefinements; ++i){
+                if (sample > 0){
+                    marchingPoint -= pow(0.5f, i) * step * refractDir;
+                }
+                else{
+                    marchingPoint += pow(0.5f, i) * step * refractDir;
+                }
+                sample = sampleLevelSet(marchingPoint);
+            }
+            exitPoint = marchingPoint;
+            break;
+        }
+    }
+    vec3 exitNormal = normalAtPoint(exitPoint);
+
+    vec3 lightColour = vec3(1.0f, 1.0f, 1.0f);
+    float ambientStrength = 0.5f;
+
+    vec3 diffuseColour = max(dot(surfaceNormal, lightDir), 0.0f) * lightColour * 2.0f;
+    vec3 ambientColour = lightColour * ambientStrength;
+
+    // Reflection
+    vec4 reflectColour = rayColour(SurfacePoint, reflect(dir, surfaceNormal));
+
+    // Exit refraction
+    float k = 1.0f - refIndex * refIndex * (1.0f - dot(exitNormal, refractDir) * dot(exitNormal, refractDir));
+    if (k < 0.0f){// TIR
+        if (exitPoint.y >= 1.5f / gridSize){
+            refractDir = reflect(refractDir, -exitNormal);
+        }
+    }
+    else{
+        refractDir = refIndex * refractDir + (refIndex * dot(-exitNormal, refractDir) + sqrt(k)) * exitNormal;
+    }
+    vec4 refractColour = rayColourBlack(exitPoint, refractDir);
+
+    float fresnel = max(0.0f, dot(-dir, surfaceNormal));
+    FragColor = mix(vec4(diffuseColour + ambientColour, 1.0f), mix(reflectColour, refractColour, fresnel), 1.0f);
+    FragColor.a = 1.0f;
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 position; // In level set texture coordinates
+layout (location = 1) in vec3 normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 SurfacePoint;
+out vec3 SurfaceNormal;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(position - vec3(0.5f, 0.5f, 0.5f), 1.0f);
+    SurfacePoint = position;
+    SurfaceNormal = normal;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 330 core
+// One vertex per column, indexed by gl_VertexID
+
+uniform sampler2D heightfieldTexture;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 SurfacePoint;
+out vec3 SurfaceNormal;
+
+#include "scene.glsl"
+
+float heightAt(ivec2 column){
+    return texelFetch(heightfieldTexture, clamp(column, ivec2(0, 0), ivec2(renderGridSize - 1, renderGridSize - 1)), 0).x;
+}
+
+void main()
+{
+    ivec2 column = ivec2(gl_VertexID % renderGridSize, gl_VertexID / renderGridSize);
+    SurfacePoint = vec3((column.x + 0.5f) / renderGridSize, heightAt(column), (column.y + 0.5f) / renderGridSize);
+
+    // Central differences, with column spacing 1/renderGridSize in texture coordinates
+    float dHdX = (heightAt(column + ivec2(1, 0)) - heightAt(column - ivec2(1, 0))) * renderGridSize / 2.0f;
+    float dHdZ = (heightAt(column + ivec2(0, 1)) - heightAt(column - ivec2(0, 1))) * renderGridSize / 2.0f;
+    SurfaceNormal = normalize(vec3(-dHdX, 1.0f, -dHdZ));
+
+    gl_Position = projection * view * model * vec4(SurfacePoint - vec3(0.5f, 0.5f, 0.5f), 1.0f);
+}
\ No newline at end of file
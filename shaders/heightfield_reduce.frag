@@ -0,0 +1,39 @@
+#version 330 core
+out vec2 FragColor; // (surface height, overhang flag)
+
+in vec2 TextureCoord;
+
+#include "level_set.glsl"
+
+// The floor's boundary layer is always outside the fluid, so fluid resting on the floor enters the level set at the
+// first interior layer (or the one above, beside the walls, where upsampling rounds the corners), and any later entry
+// means the column is dry beneath some fluid
+const int lastFloorEntry = renderGridSize / gridSize + 1;
+
+void main(){
+    ivec2 column = ivec2(TextureCoord * renderGridSize);
+
+    // Empty columns sit on the floor
+    float height = 1.0f/gridSize;
+    int firstEntry = -1;
+    int exits = 0;
+
+    float below = fetchLevelSet(ivec3(column.x, 0, column.y));
+    for (int y = 1 ; y < renderGridSize ; ++y){
+        float above = fetchLevelSet(ivec3(column.x, y, column.y));
+        if (below >= 0.0f && above < 0.0f && firstEntry < 0){
+            firstEntry = y;
+        }
+        if (below < 0.0f && above >= 0.0f){
+            // Leaving the fluid upwards
+            ++exits;
+            height = (float(y) - 0.5f + below / (below - above)) / renderGridSize;
+        }
+        below = above;
+    }
+
+    // A single-valued column enters the fluid from the floor and leaves it at most once; droplets, bubbles and fluid
+    // thrown clear of the floor do not
+    bool overhang = exits > 1 || firstEntry > lastFloorEntry;
+    FragColor = vec2(height, overhang ? 1.0f : 0.0f);
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Sampling the render copy of the level set, which holds clamp(phi / band, -1, 1), remapped to [0, 1]
+#include "scene.glsl"
+
+uniform sampler3D levelSetTexture;
+
+float sampleLevelSet(vec3 pt){
+    return texture(levelSetTexture, pt).x * 2.0f - 1.0f;
+}
+
+// For the upsampled level set only, which has renderGridSize voxels along each side
+float fetchLevelSet(ivec3 voxel){
+    return texelFetch(levelSetTexture, clamp(voxel, ivec3(0), ivec3(renderGridSize - 1)), 0).x * 2.0f - 1.0f;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+// One invocation per grid cell, i.e. per cube whose corners are neighbouring voxel centres
+
+#include "scene.glsl"
+
+const int cellsPerSide = renderGridSize - 1;
+
+flat out ivec3 cell;
+
+void main()
+{
+    cell = ivec3(gl_VertexID % cellsPerSide, (gl_VertexID / cellsPerSide) % cellsPerSide, gl_VertexID / (cellsPerSide * cellsPerSide));
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TextureCoord;
+flat in int View;
+
+uniform sampler3D normalTexture; // Shared by all views, computed once per level set
+uniform sampler3D occupancyTexture;
+
+const int maxViews = 16; // Views per pass
+uniform mat4 inverseViewProjections[maxViews];
+uniform vec3 cameraPositions[maxViews]; // In level set texture coordinates
+
+#include "level_set.glsl"
+#include "environment.glsl"
+
+const int occupancyGridSize = 16; // Each occupancy brick covers 4^3 render voxels
+
+const float step = 1.0f/(2 * renderGridSize); // Half render voxel size
+
+vec3 normalAtPoint(vec3 pt){
+    return normalize(texture(normalTexture, pt).xyz * 2.0f - 1.0f);
+}
+
+// Distances along a ray to where it enters and leaves the cube
+vec2 cubeIntersection(vec3 start, vec3 dir){
+    vec3 t0 = (vec3(0.0f, 0.0f, 0.0f) - start) / dir;
+    vec3 t1 = (vec3(1.0f, 1.0f, 1.0f) - start) / dir;
+    float entry = max(max(min(t0.x, t1.x), min(t0.y, t1.y)), min(t0.z, t1.z));
+    float exit = min(min(max(t0.x, t1.x), max(t0.y, t1.y)), max(t0.z, t1.z));
+    return vec2(max(entry, 0.0f), exit);
+}
+
+// Steps along a ray until it leaves (inside) or enters (!inside) the fluid, skipping bricks without surface
+bool marchToSurface(vec3 start, vec3 dir, float maxLength, bool inside, out vec3 hitPoint){
+    vec3 safeDir = mix(vec3(1e-6f), dir, greaterThan(abs(dir), vec3(1e-6f)));
+    float previous = 0.0f;
+    float t = 0.0f;
+    for (int i = 0 ; i < 4 * renderGridSize && t < maxLength ; ++i){
+        vec3 pt = start + t * dir;
+        ivec3 brick = clamp(ivec3(floor(pt * occupancyGridSize)), ivec3(0), ivec3(occupancyGridSize - 1));
+        if (texelFetch(occupancyTexture, brick, 0).x < 0.5f){
+            // Jump to the far side of the brick
+            vec3 brickExit = (vec3(brick) + vec3(greaterThan(dir, vec3(0.0f)))) / occupancyGridSize;
+            vec3 tBrick = (brickExit - start) / safeDir;
+            previous = max(min(min(tBrick.x, tBrick.y), tBrick.z), t);
+            t = previous + 1e-4f;
+            continue;
+        }
+        if ((sampleLevelSet(pt) < 0.0f) != inside){
+            // Hitpoint refinement
+            const int numberOfRefinements = 6;
+            for (int j = 0 ; j < numberOfRefinements ; ++j){
+                float middle = 0.5f * (previous + t);
+                if ((sampleLevelSet(start + middle * dir) < 0.0f) != inside){
+                    t = middle;
+                }
+                else{
+                    previous = middle;
+                }
+            }
+            hitPoint = start + t * dir;
+            return true;
+        }
+        previous = t;
+        t += step;
+    }
+    hitPoint = start + maxLength * dir;
+    return false;
+}
+
+void main()
+{
+    vec3 cameraPosition = cameraPositions[View];
+    vec4 farPoint = inverseViewProjections[View] * vec4(2.0f * TextureCoord - 1.0f, 1.0f, 1.0f);
+    vec3 dir = normalize(farPoint.xyz / (farPoint.w * cubeScale) + vec3(0.5f, 0.5f, 0.5f) - cameraPosition);
+
+    // Background seen directly by the camera - as in the main view, only the lit floor is drawn
+    FragColor = vec4(rayColourBlack(cameraPosition, dir).xyz, 1.0f);
+
+    vec2 cube = cubeIntersection(cameraPosition, dir);
+    if (cube.x >= cube.y){
+        return;
+    }
+    vec3 surfacePoint;
+    if (!marchToSurface(cameraPosition + cube.x * dir, dir, cube.y - cube.x, false, surfacePoint)){
+        return;
+    }
+    vec3 surfaceNormal = normalAtPoint(surfacePoint);
+
+    const float refIndex = 1.33;
+    vec3 refractDir = normalize(refract(dir, surfaceNormal, 1.0f/refIndex));
+    vec3 refractStart = surfacePoint + 0.05f * step * refractDir;
+    vec3 exitPoint;
+    marchToSurface(refractStart, refractDir, cubeIntersection(refractStart, refractDir).y, true, exitPoint);
+    vec3 exitNormal = normalAtPoint(exitPoint);
+
+    vec3 lightColour = vec3(1.0f, 1.0f, 1.0f);
+    float ambientStrength = 0.5f;
+
+    vec3 diffuseColour = max(dot(surfaceNormal, lightDir), 0.0f) * lightColour * 2.0f;
+    vec3 ambientColour = lightColour * ambientStrength;
+
+    // Reflection
+    vec4 reflectColour = rayColour(surfacePoint, reflect(dir, surfaceNormal));
+
+    // Exit refraction
+    float k = 1.0f - refIndex * refIndex * (1.0f - dot(exitNormal, refractDir) * dot(exitNormal, refractDir));
+    if (k < 0.0f){// TIR
+        if (exitPoint.y >= 1.5f / gridSize){
+            refractDir = reflect(refractDir, -exitNormal);
+        }
+    }
+    else{
+        refractDir = refIndex * refractDir + (refIndex * dot(-exitNormal, refractDir) + sqrt(k)) * exitNormal;
+    }
+    vec4 refractColour = rayColourBlack(exitPoint, refractDir);
+
+    float fresnel = max(0.0f, dot(-dir, surfaceNormal));
+    FragColor = mix(vec4(diffuseColour + ambientColour, 1.0f), mix(reflectColour, refractColour, fresnel), 1.0f);
+    FragColor.a = 1.0f;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+// Attribute-less full screen triangle, instanced once per view
+out vec2 vTextureCoord;
+flat out int vView;
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vTextureCoord = position;
+    vView = gl_InstanceID;
+    gl_Position = vec4(2.0f * position - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
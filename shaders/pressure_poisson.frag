@@ -1,20 +1,12 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TextureCoord;
+#include "slab.glsl"
 
 uniform sampler3D pressureTexture; // pressure
 uniform sampler3D levelSetTexture; // level set
 uniform sampler3D divergenceTexture; // div(velocity)
 
-uniform float timeStep; // in microseconds
-uniform float zSlice;
-
-const int gridSize = 32;
-const float step = 1.0f/gridSize;
-
-vec3 lookUpCoords = vec3(TextureCoord, zSlice * step + 0.5f * step);
-
 float solvePoisson(){
 
     float quantityPosX = texture(pressureTexture, lookUpCoords + vec3(step, 0.0f, 0.0f)).x;
@@ -28,7 +20,6 @@ float solvePoisson(){
 }
 
 void main(){
-    timeStep;
     if (texture(levelSetTexture, lookUpCoords ).x > 0)
     {
         FragColor = vec4(0.0f, 0.0f, 0.0f, 0.0f); // No pressure outside fluid
@@ -1,21 +1,12 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TextureCoord;
+#include "slab.glsl"
 
 uniform sampler3D velocityTexture; // velocity
 uniform sampler3D pressureTexture; // poisson'd pressure
 
-uniform float timeStep; // in microseconds
-uniform float zSlice;
-
-const int gridSize = 32;
-const float step = 1.0f/gridSize;
-
-vec3 lookUpCoords = vec3(TextureCoord, zSlice * step + 0.5f * step);
-
 void main(){
-    timeStep;
     // Error O(h^2) grad approximation
     /* float quantityPosX = texture(pressureTexture, lookUpCoords + vec3(step, 0.0f, 0.0f)).x;
     float quantityNegX = texture(pressureTexture, lookUpCoords + vec3(-step, 0.0f, 0.0f)).x;
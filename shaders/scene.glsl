@@ -0,0 +1,6 @@
+// Constants shared by the simulation and rendering shaders
+// GRID_SIZE and RENDER_GRID_SIZE are defined by the application, from gridSize and renderGridSize in fluid.hpp
+const int gridSize = GRID_SIZE;
+const int renderGridSize = RENDER_GRID_SIZE; // Resolution of the upsampled render level set
+const float cubeScale = 1.5f;
+const vec3 lightDir = normalize(vec3(1.0f, 2.0f, 1.0f));
\ No newline at end of file
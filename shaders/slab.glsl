@@ -0,0 +1,14 @@
+// Common to the slab operation fragment shaders, which are run once per cell of the z-slice being written
+#include "scene.glsl"
+
+in vec2 TextureCoord;
+
+layout(std140) uniform FrameConstants{ // Shared by all slab operations, updated once per frame
+    float timeStep; // in microseconds
+    vec3 extForce; // Set to zero when no force applied
+};
+#include "slice.glsl"
+
+const float step = 1.0f/gridSize;
+
+vec3 lookUpCoords = vec3(TextureCoord, zSlice * step + 0.5f * step);
\ No newline at end of file
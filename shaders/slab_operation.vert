@@ -1,14 +1,17 @@
 #version 330 core
+#include "slice_vertex.glsl"
 layout (location = 0) in vec2 position;
 layout (location = 1 ) in vec2 textureCoord;
 
-uniform mat4 model;
-uniform mat4 projection;
+layout(std140) uniform GridConstants{ // Shared by all slab operations
+    mat4 slabTransform; // Projection and model matrices, mapping the unit quad to a slab
+};
 
 out vec2 TextureCoord;
 
 void main()
 {
-    gl_Position = projection * model * vec4(position, 0.0f, 1.0);
+    gl_Position = slabTransform * vec4(position, 0.0f, 1.0);
     TextureCoord = textureCoord;
+    setSlice();
 }
\ No newline at end of file
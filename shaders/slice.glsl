@@ -0,0 +1,10 @@
+// The z-slice of the 3D target being written: set before each draw, or given by the instance of a layered draw
+// (see slice_vertex.glsl)
+#include "slice_paths.glsl"
+
+#if SLICE_PATH == SLICE_PATH_PER_SLICE
+uniform float zSlice;
+#else
+flat in int layerSlice;
+#define zSlice float(layerSlice)
+#endif
\ No newline at end of file
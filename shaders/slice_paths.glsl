@@ -0,0 +1,8 @@
+// How z-slices of 3D targets are written, as chosen by the renderer, which defines SLICE_PATH for the programs that
+// write them. A layered path draws every slice with one instanced draw
+#define SLICE_PATH_PER_SLICE 0
+#define SLICE_PATH_GEOMETRY_LAYER 1 // gl_Layer is set by slice_layer.geom
+#define SLICE_PATH_VERTEX_LAYER 2 // gl_Layer is set by the vertex shader
+#ifndef SLICE_PATH
+#define SLICE_PATH SLICE_PATH_PER_SLICE
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+// Included straight after #version by vertex shaders that write z-slices of 3D targets. Layered draws start from
+// firstSlice
+#include "slice_paths.glsl"
+
+#if SLICE_PATH == SLICE_PATH_VERTEX_LAYER
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+#elif SLICE_PATH == SLICE_PATH_GEOMETRY_LAYER
+// The geometry shader passes the outputs on under their usual names
+#define TextureCoord vertexTextureCoord
+#define layerSlice vertexSlice
+#endif
+
+#if SLICE_PATH != SLICE_PATH_PER_SLICE
+uniform int firstSlice;
+flat out int layerSlice;
+#endif
+
+void setSlice(){
+#if SLICE_PATH != SLICE_PATH_PER_SLICE
+    layerSlice = firstSlice + gl_InstanceID;
+#endif
+#if SLICE_PATH == SLICE_PATH_VERTEX_LAYER
+    gl_Layer = layerSlice;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TextureCoord;
+
+#include "level_set.glsl" // levelSetTexture is the render copy at simulation resolution
+
+uniform sampler3D detailCoordinatesTexture;
+uniform sampler1D splineTexture;
+#include "slice.glsl"
+
+// Defined by the renderer, which builds a variant of this shader for each setting
+const bool addDetail = bool(ADD_DETAIL);
+
+const float levelSetBand = 4.0f; // As in encode_level_set.frag, in simulation voxels
+const float detailAmplitude = 0.1f; // In simulation voxels
+const float detailFrequency = 24.0f; // Noise cells across the domain
+const float detailFalloff = 1.5f; // Detail fades out this far from the surface, in simulation voxels
+
+// Tricubic B-spline reconstruction using eight trilinear fetches
+// splineTexture holds (g0, g1, -h0, h1), where f(x) = g0 * f(i - h0) + g1 * f(i + h1)
+float tricubicLevelSet(vec3 pt){
+    vec3 splineCoords = pt * float(gridSize) - vec3(0.5f, 0.5f, 0.5f);
+    vec4 ghX = texture(splineTexture, splineCoords.x);
+    vec4 ghY = texture(splineTexture, splineCoords.y);
+    vec4 ghZ = texture(splineTexture, splineCoords.z);
+    ghX.zw /= gridSize;
+    ghY.zw /= gridSize;
+    ghZ.zw /= gridSize;
+
+    return ghZ.x * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.z)) +
+                             ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.z))) +
+                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.z)) +
+                             ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.z)))) +
+           ghZ.y * (ghY.x * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.z, ghZ.w)) +
+                             ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.z, ghZ.w))) +
+                    ghY.y * (ghX.x * sampleLevelSet(pt + vec3(ghX.z, ghY.w, ghZ.w)) +
+                             ghX.y * sampleLevelSet(pt + vec3(ghX.w, ghY.w, ghZ.w))));
+}
+
+////////////////
+// Procedural detail
+float hash(vec3 p){
+    p = fract(p * 0.3183099f + 0.1f);
+    p *= 17.0f;
+    return fract(p.x * p.y * p.z * (p.x + p.y + p.z));
+}
+
+// Smoothly interpolated value noise in [-1, 1]
+float valueNoise(vec3 x){
+    vec3 i = floor(x);
+    vec3 f = fract(x);
+    f = f * f * (3.0f - 2.0f * f);
+    float noise = mix(mix(mix(hash(i + vec3(0.0f, 0.0f, 0.0f)), hash(i + vec3(1.0f, 0.0f, 0.0f)), f.x),
+                          mix(hash(i + vec3(0.0f, 1.0f, 0.0f)), hash(i + vec3(1.0f, 1.0f, 0.0f)), f.x), f.y),
+                      mix(mix(hash(i + vec3(0.0f, 0.0f, 1.0f)), hash(i + vec3(1.0f, 0.0f, 1.0f)), f.x),
+                          mix(hash(i + vec3(0.0f, 1.0f, 1.0f)), hash(i + vec3(1.0f, 1.0f, 1.0f)), f.x), f.y), f.z);
+    return 2.0f * noise - 1.0f;
+}
+////////////
+
+void main(){
+    vec3 pt = vec3(TextureCoord, (zSlice + 0.5f) / renderGridSize);
+    float levelSet = tricubicLevelSet(pt);
+
+    if (addDetail){
+        // Noise is looked up at coordinates advected with the flow, so the detail moves with the fluid
+        vec3 detailCoords = texture(detailCoordinatesTexture, pt).xyz * detailFrequency;
+        float detail = valueNoise(detailCoords) + 0.5f * valueNoise(2.0f * detailCoords);
+        float nearSurface = 1.0f - smoothstep(0.0f, detailFalloff / levelSetBand, abs(levelSet));
+        levelSet += nearSurface * detail * detailAmplitude / levelSetBand;
+    }
+
+    FragColor = vec4(clamp(levelSet, -1.0f, 1.0f) * 0.5f + 0.5f);
+}
\ No newline at end of file
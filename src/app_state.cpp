@@ -5,11 +5,14 @@ AppState::AppState(unsigned int w, unsigned int h, unsigned int scale) :
     m_notionalWindowWidth{w},
     m_notionalWindowHeight{h},
     m_quitApplication{false},
+    m_tLaunch{std::chrono::high_resolution_clock::now()},
+    m_firstFramePresented{false},
     m_window(m_notionalWindowWidth * m_windowDisplayScale, m_notionalWindowHeight * m_windowDisplayScale), 
     m_context(m_window.getWindow(), m_notionalWindowWidth* m_windowDisplayScale, m_notionalWindowHeight * m_windowDisplayScale),
     m_fluid(m_notionalWindowWidth * m_windowDisplayScale, m_notionalWindowHeight * m_windowDisplayScale),
     m_guiState(m_notionalWindowWidth, m_notionalWindowHeight)
 {
+    ShaderCache::report();
 }
 
 bool AppState::successfullyInitialised() const{
@@ -25,6 +28,8 @@ void AppState::beginLoop(){
 }
 
 void AppState::mainLoop(){
+    TRACE_SCOPE("AppState::mainLoop");
+    Tracer::calibrateGPUClock();
     SDL_Event event;
     while (SDL_PollEvent(&event)){
         handleEvents(event);
@@ -33,15 +38,11 @@ void AppState::mainLoop(){
     m_tNow = std::chrono::high_resolution_clock::now();
     unsigned int frameTime = std::chrono::duration_cast<std::chrono::microseconds>(m_tNow - m_tStart).count();
     m_tStart = m_tNow;
-
-    // Cap frame length to 250 ms
-    if (frameTime > 250000){
-        frameTime = 250000;
-    }
     frame(frameTime);
 }
 
 void AppState::handleEvents(SDL_Event const&  event){
+    TRACE_SCOPE("AppState::handleEvents");
     switch(event.type){
         case SDL_QUIT:
             quitApp();
@@ -51,6 +52,15 @@ void AppState::handleEvents(SDL_Event const&  event){
                 case SDL_SCANCODE_F11:
                     m_window.toggleFullScreen();
                     break;
+                case SDL_SCANCODE_F3:
+                    m_guiState.toggleTimingHUD();
+                    break;
+                case SDL_SCANCODE_F4:
+                    Tracer::write();
+                    break;
+                case SDL_SCANCODE_F5:
+                    GLCallCounter::dump(std::cout);
+                    break;
                 default:
                     break;
             }
@@ -64,9 +74,28 @@ void AppState::handleEvents(SDL_Event const&  event){
 void AppState::frame(unsigned int frameTime){
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    m_fluid.frame(frameTime);
+    // The frame statistics record the real frame length, but the time step is capped
+    m_fluid.frame(std::min(frameTime, m_maxTimeStep));
+    if (m_guiState.isTimingHUDVisible()){
+        m_guiState.addStageTimes(m_fluid.getStageTimes());
+        m_guiState.addStateCacheStatistics(GLStateCache::getFrameStatistics());
+        if (GLCallCounter::isInstalled()){
+            m_guiState.addGLCallCounts(GLCallCounter::getFrameCounts());
+        }
+    }
     m_guiState.frame();
-    SDL_GL_SwapWindow(m_window.getWindow());
+    {
+        TRACE_SCOPE("SwapWindow");
+        SDL_GL_SwapWindow(m_window.getWindow());
+    }
+    if (!m_firstFramePresented){
+        // Startup time as seen by the user, so includes waiting for the GPU to finish the first frame
+        glFinish();
+        std::cout << "First frame: " << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - m_tLaunch).count() / 1000.0 << " ms after startup\n";
+        m_firstFramePresented = true;
+    }
+    GLCallCounter::endFrame();
+    GLStateCache::endFrame();
     m_window.frame(frameTime);
 }
 
@@ -74,6 +103,10 @@ void AppState::quitApp(){
     m_quitApplication = true;
 }
 
+bool AppState::writeFrameStatistics(std::string const& path){
+    return m_window.writeFrameStatistics(path);
+}
+
 bool AppState::timeToQuit() const{
     return m_quitApplication;
 }
\ No newline at end of file
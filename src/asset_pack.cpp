@@ -0,0 +1,119 @@
+#include "asset_pack.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+unsigned char const* AssetPack::m_pack = nullptr;
+std::uint64_t AssetPack::m_size = 0;
+AssetPack::Header const* AssetPack::m_header = nullptr;
+AssetPack::Entry const* AssetPack::m_entries = nullptr;
+
+// Maps the pack, returning false (and leaving every asset to be loaded from disk) if it is missing or malformed
+bool AssetPack::open(std::string const& path){
+    void const* pack = nullptr;
+    std::uint64_t size = 0;
+    #ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0){
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping){
+            pack = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            size = fileSize.QuadPart;
+            CloseHandle(mapping); // The view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+    #else
+    int const file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0){
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0){
+        pack = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (pack == MAP_FAILED){
+            pack = nullptr;
+        }
+        size = status.st_size;
+    }
+    ::close(file); // The mapping keeps the file open
+    #endif
+    if (!pack){
+        std::cerr << "[ERROR]: Failed to map asset pack " << path << "\n";
+        return false;
+    }
+
+    Header const* header = (Header const*)pack;
+    bool valid = size >= sizeof(Header) && header->magic == fileMagic && header->version == fileVersion
+              && size >= sizeof(Header) + (std::uint64_t)header->numEntries * sizeof(Entry) + header->nameBytes;
+    Entry const* entries = (Entry const*)(header + 1);
+    for (std::uint32_t i = 0 ; valid && i < header->numEntries ; ++i){
+        valid = entries[i].offset + entries[i].size <= size && entries[i].nameOffset + entries[i].nameLength <= header->nameBytes;
+    }
+    if (!valid){
+        std::cerr << "[ERROR]: " << path << " is not a valid asset pack (version " << fileVersion << ")\n";
+        #ifdef _WIN32
+        UnmapViewOfFile(pack);
+        #else
+        munmap((void*)pack, size);
+        #endif
+        return false;
+    }
+    m_pack = (unsigned char const*)pack;
+    m_size = size;
+    m_header = header;
+    m_entries = entries;
+    return true;
+}
+
+bool AssetPack::isOpen(){
+    return m_pack != nullptr;
+}
+
+// Binary search of the sorted index, returning nullptr if the asset is not in the pack
+AssetPack::Entry const* AssetPack::find(std::string const& path){
+    if (!m_pack){
+        return nullptr;
+    }
+    std::string const key = normalise(path);
+    Entry const* end = m_entries + m_header->numEntries;
+    Entry const* entry = std::lower_bound(m_entries, end, key, [](Entry const& entry, std::string const& key){
+        return name(entry) < key;
+    });
+    return (entry != end && name(*entry) == key) ? entry : nullptr;
+}
+
+unsigned char const* AssetPack::data(Entry const& entry){
+    return m_pack + entry.offset;
+}
+
+// The pack's name for a path: ".//shaders//fluid.frag" and "shaders/fluid.frag" are both "shaders/fluid.frag"
+std::string AssetPack::normalise(std::string const& path){
+    std::string result;
+    for (char c : path){
+        c = c == '\\' ? '/' : c;
+        if (c != '/' || (!result.empty() && result.back() != '/')){
+            result += c;
+        }
+    }
+    while (result.compare(0, 2, "./") == 0){
+        result.erase(0, 2);
+    }
+    return result;
+}
+
+std::string_view AssetPack::name(Entry const& entry){
+    return std::string_view((char const*)(m_entries + m_header->numEntries) + entry.nameOffset, entry.nameLength);
+}
\ No newline at end of file
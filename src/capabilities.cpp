@@ -0,0 +1,157 @@
+#include "capabilities.hpp"
+
+int Capabilities::m_majorVersion = 0;
+int Capabilities::m_minorVersion = 0;
+Capabilities::Features Capabilities::m_features;
+std::vector<std::string> Capabilities::m_disabled;
+bool Capabilities::m_slicePathForced = false;
+Capabilities::SlicePath Capabilities::m_slicePath = Capabilities::SlicePath::perSlice;
+
+static char const* const slicePathNames[] = {"per-slice", "geometry-layer", "vertex-layer"};
+
+// Returns false for an unknown feature name
+bool Capabilities::disable(std::string const& feature){
+    if (!Capabilities::feature(feature)){
+        return false;
+    }
+    m_disabled.push_back(feature);
+    return true;
+}
+
+bool Capabilities::forceSlicePath(std::string const& path){
+    for (int i = 0 ; i < 3 ; ++i){
+        if (path == slicePathNames[i]){
+            m_slicePath = (SlicePath)i;
+            m_slicePathForced = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Must be called with a current context, before anything that depends on the chosen paths is created
+void Capabilities::probe(){
+    glGetIntegerv(GL_MAJOR_VERSION, &m_majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &m_minorVersion);
+    int const version = 10 * m_majorVersion + m_minorVersion;
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    std::vector<std::string> extensions;
+    for (GLint i = 0 ; i < numExtensions ; ++i){
+        extensions.push_back((char const*)glGetStringi(GL_EXTENSIONS, i));
+    }
+
+    m_features.computeShaders = version >= 43 || hasExtension(extensions, "GL_ARB_compute_shader");
+    m_features.textureBarrier = version >= 45 || hasExtension(extensions, "GL_ARB_texture_barrier") || hasExtension(extensions, "GL_NV_texture_barrier");
+    m_features.floatTargets = isRenderable(GL_R32F) && isRenderable(GL_RGBA32F);
+    m_features.rgbFloatTargets = isRenderable(GL_RGB32F);
+    m_features.halfTargets = isRenderable(GL_R16F) && isRenderable(GL_RGBA16F);
+    #ifndef __EMSCRIPTEN__
+    m_features.layeredRendering = isLayeredRenderable();
+    m_features.vertexShaderLayer = m_features.layeredRendering && (hasExtension(extensions, "GL_ARB_shader_viewport_layer_array")
+                                                                || hasExtension(extensions, "GL_AMD_vertex_shader_layer"));
+    GLint timestampBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+    m_features.timerQueries = timestampBits > 0;
+    #endif
+    glGetError(); // Any probe the driver rejected outright leaves an error behind
+    for (std::string const& name : m_disabled){
+        *feature(name) = false;
+    }
+    m_features.vertexShaderLayer &= m_features.layeredRendering;
+
+    // Fewer, larger draws are faster wherever they are possible
+    SlicePath const bestSlicePath = m_features.vertexShaderLayer ? SlicePath::vertexLayer
+                                  : (m_features.layeredRendering ? SlicePath::geometryLayer : SlicePath::perSlice);
+    if (!m_slicePathForced || (m_slicePath == SlicePath::vertexLayer && !m_features.vertexShaderLayer)
+                           || (m_slicePath == SlicePath::geometryLayer && !m_features.layeredRendering)){
+        if (m_slicePathForced){
+            std::cerr << "[ERROR]: Slice path " << slicePathNames[(int)m_slicePath] << " is unavailable\n";
+        }
+        m_slicePath = bestSlicePath;
+    }
+}
+
+void Capabilities::report(){
+    auto yesNo = [](bool feature){
+        return feature ? "yes" : "no";
+    };
+    std::cout << "GL " << m_majorVersion << "." << m_minorVersion << ": compute shaders " << yesNo(m_features.computeShaders)
+              << ", layered rendering " << yesNo(m_features.layeredRendering) << " (from vertex shader " << yesNo(m_features.vertexShaderLayer)
+              << "), texture barrier " << yesNo(m_features.textureBarrier) << ", timer queries " << yesNo(m_features.timerQueries)
+              << ", float targets " << yesNo(m_features.floatTargets) << " (RGB " << yesNo(m_features.rgbFloatTargets)
+              << "), half targets " << yesNo(m_features.halfTargets) << "\n";
+    for (std::string const& name : m_disabled){
+        std::cout << "Disabled " << name << "\n";
+    }
+    std::cout << "Slice path: " << slicePathNames[(int)m_slicePath] << (m_slicePathForced ? " (forced)" : "")
+              << ", vector grids: " << (vectorFormat() == GL_RGB32F ? "RGB32F" : "RGBA32F") << "\n";
+    if (!m_features.floatTargets){
+        std::cerr << "[ERROR]: Float render targets are unsupported\n";
+    }
+}
+
+Capabilities::Features const& Capabilities::features(){
+    return m_features;
+}
+
+Capabilities::SlicePath Capabilities::slicePath(){
+    return m_slicePath;
+}
+
+// Format of the vector simulation grids - RGB32F where it can be rendered to, as it is three quarters the size of RGBA32F
+GLint Capabilities::vectorFormat(){
+    return m_features.rgbFloatTargets ? GL_RGB32F : GL_RGBA32F;
+}
+
+bool Capabilities::hasExtension(std::vector<std::string> const& extensions, char const* name){
+    return std::find(extensions.begin(), extensions.end(), name) != extensions.end();
+}
+
+// Whether a z-slice of a 3D texture in the format can be rendered to
+bool Capabilities::isRenderable(GLint internalFormat){
+    GLuint texture, framebuffer;
+    glGenTextures(1, &texture);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, internalFormat, 4, 4, 4, 0, GL_RED, GL_FLOAT, NULL);
+    glGenFramebuffers(1, &framebuffer);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0, 1);
+    bool const renderable = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    GLStateCache::deleteFramebuffers(1, &framebuffer);
+    GLStateCache::deleteTextures(1, &texture);
+    return renderable;
+}
+
+#ifndef __EMSCRIPTEN__
+// Whether a whole 3D texture can be attached, with draws selecting the slice by gl_Layer
+bool Capabilities::isLayeredRenderable(){
+    GLuint texture, framebuffer;
+    glGenTextures(1, &texture);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, 4, 4, 4, 0, GL_RED, GL_FLOAT, NULL);
+    glGenFramebuffers(1, &framebuffer);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0);
+    bool const renderable = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    GLStateCache::deleteFramebuffers(1, &framebuffer);
+    GLStateCache::deleteTextures(1, &texture);
+    return renderable;
+}
+#endif
+
+// The flag for a feature name used on the command line, or nullptr if there is none
+bool* Capabilities::feature(std::string const& name){
+    static std::pair<char const*, bool Features::*> const names[] = {
+        {"compute-shaders", &Features::computeShaders}, {"layered-rendering", &Features::layeredRendering},
+        {"vertex-shader-layer", &Features::vertexShaderLayer}, {"texture-barrier", &Features::textureBarrier},
+        {"timer-queries", &Features::timerQueries}, {"float-targets", &Features::floatTargets},
+        {"rgb-float-targets", &Features::rgbFloatTargets}, {"half-targets", &Features::halfTargets}
+    };
+    for (auto const& [featureName, flag] : names){
+        if (name == featureName){
+            return &(m_features.*flag);
+        }
+    }
+    return nullptr;
+}
\ No newline at end of file
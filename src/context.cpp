@@ -12,19 +12,31 @@ Context::Context(SDL_Window* window, unsigned int width, unsigned int height) :
         #ifndef __EMSCRIPTEN__
         // Load OpenGL functions with GLAD
         gladLoadGLLoader(SDL_GL_GetProcAddress);
+        ShaderCache::initialise(SDL_GL_GetProcAddress);
+        bool const parallelShaderCompile = ShaderProgram::initialise(SDL_GL_GetProcAddress);
+        #ifdef FLUID_COUNT_GL_CALLS
+        GLCallCounter::install();
+        #endif
         #endif
 
         // Display device information
         printf("Vendor:   %s\n", glGetString(GL_VENDOR));
         printf("Renderer: %s\n", glGetString(GL_RENDERER));
         printf("Version:  %s\n", glGetString(GL_VERSION));
+        #ifndef __EMSCRIPTEN__
+        printf("Parallel shader compile: %s\n", parallelShaderCompile ? "enabled" : "unavailable");
+        #endif
+
+        // Choose the simulation and render paths before anything depending on them is created
+        Capabilities::probe();
+        Capabilities::report();
 
         // Set v-sync
         SDL_GL_SetSwapInterval(useVsync);
 
-        glViewport(0, 0, viewportWidth, viewportHeight);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLStateCache::viewport(0, 0, viewportWidth, viewportHeight);
+        GLStateCache::enable(GL_BLEND);
+        GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         m_successfullyInitialised = true;
     }
     catch(std::exception const& e){
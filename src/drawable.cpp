@@ -16,17 +16,21 @@ Drawable::~Drawable(){
 }
 
 void Drawable::bindVAO() const{
-    glBindVertexArray(m_VAO);
+    GLStateCache::bindVertexArray(m_VAO);
 }
 
 void Drawable::unbindVAO(){
-    glBindVertexArray(0);
+    GLStateCache::bindVertexArray(0);
 }
 
 void Drawable::draw(GLint drawingMode) const{
     glDrawArrays(drawingMode, 0, m_vertices.size());
 }
 
+void Drawable::drawInstanced(GLint drawingMode, GLsizei instances) const{
+    glDrawArraysInstanced(drawingMode, 0, m_vertices.size(), instances);
+}
+
 bool Drawable::successfullyInitialised() const{
     return m_successfullyInitialised;
 }
@@ -54,6 +58,6 @@ void Drawable::setUpBuffers(unsigned int vertexDimension){
 }
 
 void Drawable::releaseBuffers(){
-    glDeleteVertexArrays(1, &m_VAO);
+    GLStateCache::deleteVertexArrays(1, &m_VAO);
     glDeleteBuffers(1, &m_VBO);
 }
\ No newline at end of file
@@ -1,5 +1,28 @@
 #include "fluid.hpp"
 
+// Every simulation and rendering shader is built with the grid sizes #defined (see shaders/scene.glsl)
+static std::vector<std::string> shaderDefines(std::vector<std::string> defines = {}){
+    defines.push_back("GRID_SIZE " + std::to_string(gridSize));
+    defines.push_back("RENDER_GRID_SIZE " + std::to_string(renderGridSize));
+    return defines;
+}
+
+// For programs writing z-slices of 3D targets, which are built for the slice path chosen by Capabilities
+static std::vector<std::string> sliceDefines(std::vector<std::string> defines = {}){
+    char const* const paths[] = {"SLICE_PATH_PER_SLICE", "SLICE_PATH_GEOMETRY_LAYER", "SLICE_PATH_VERTEX_LAYER"};
+    defines.push_back(std::string("SLICE_PATH ") + paths[(int)Capabilities::slicePath()]);
+    return shaderDefines(defines);
+}
+
+static std::string sliceGeometryShader(){
+    return Capabilities::slicePath() == Capabilities::SlicePath::geometryLayer ? ".//shaders//slice_layer.geom" : "";
+}
+
+// The slice uniform is the z-slice of a per-slice draw (float) or the first slice of a layered draw (int)
+static char const* sliceUniform(){
+    return Capabilities::slicePath() == Capabilities::SlicePath::perSlice ? "zSlice" : "firstSlice";
+}
+
 FluidSimulator::FluidSimulator() : 
     m_advectionLevelSet(".//shaders//slab_operation.vert", ".//shaders//advect_quantity.frag", {"velocityTexture", "quantityTexture"}),
     m_advectionVelocity(".//shaders//slab_operation.vert", ".//shaders//advect_velocity.frag", {"velocityTexture", "quantityTexture"}),
@@ -9,17 +32,20 @@ FluidSimulator::FluidSimulator() :
     m_pressurePoisson(".//shaders//slab_operation.vert", ".//shaders//pressure_poisson.frag", {"pressureTexture", "levelSetTexture", "divergenceTexture"}),
     m_divergence(".//shaders//slab_operation.vert", ".//shaders//divergence.frag", {"velocityTexture"}),
     m_removeDivergence(".//shaders//slab_operation.vert", ".//shaders//remove_divergence.frag", {"velocityTexture", "pressureTexture"}),
-    m_boundaryVelocity(".//shaders//slab_operation.vert", ".//shaders//boundary_velocity.frag", {"velocityTexture"}),
-    m_boundaryLevelSet(".//shaders//slab_operation.vert", ".//shaders//boundary_levelset.frag", {"levelSetTexture"}),
-    m_boundaryPressure(".//shaders//slab_operation.vert", ".//shaders//boundary_pressure.frag", {"pressureTexture"}),
+    m_advectionDetail(".//shaders//slab_operation.vert", ".//shaders//advect_detail.frag", {"velocityTexture", "quantityTexture"}),
+    m_boundaryVelocity(".//shaders//slab_operation.vert", ".//shaders//boundary.frag", {"quantityTexture"}, {"BOUNDARY_MODE BOUNDARY_NEGATE"}),
+    m_boundaryLevelSet(".//shaders//slab_operation.vert", ".//shaders//boundary.frag", {"quantityTexture"}, {"BOUNDARY_MODE BOUNDARY_OUTSIDE"}),
+    m_boundaryPressure(".//shaders//slab_operation.vert", ".//shaders//boundary.frag", {"quantityTexture"}, {"BOUNDARY_MODE BOUNDARY_COPY"}),
     m_clearSlabs(".//shaders//slab_operation.vert", ".//shaders//clear_slabs.frag", {}),
+    m_encodeLevelSet(".//shaders//slab_operation.vert", ".//shaders//encode_level_set.frag", {"levelSetTexture"}),
     m_appliedForce{0.0f, 0.0f, 0.0f}
 {
     try{
         m_successfullyInitialised = false;
-        initialiseUniforms();
         initialiseTextures();
-        initialiseFramebufferObjects();
+        if (!buildPassGraph()){
+            throw std::runtime_error("Failed to compile the integration step");
+        }
         m_successfullyInitialised = true;
     }
     catch (std::exception const& e){
@@ -29,38 +55,107 @@ FluidSimulator::FluidSimulator() :
 }
 
 void FluidSimulator::update(unsigned int frameTime){
+    TRACE_SCOPE("FluidSimulator::update");
     integrateFluid(frameTime);
 }
 
+// Called by Fluid once the renderer has issued its programs too, so that all of them build concurrently
+void FluidSimulator::initialiseShaders(){
+    std::vector<SlabOperation*> const slabOps{&m_advectionLevelSet, &m_advectionVelocity, &m_diffusion, &m_forceApplication, &m_passThrough, &m_pressurePoisson,
+                                              &m_divergence, &m_removeDivergence, &m_advectionDetail, &m_boundaryVelocity, &m_boundaryLevelSet,
+                                              &m_boundaryPressure, &m_clearSlabs, &m_encodeLevelSet};
+    for (SlabOperation* slabOp : slabOps){
+        slabOp->initialiseUniforms();
+    }
+}
+
 bool FluidSimulator::successfullyInitialised() const {
     return m_successfullyInitialised;
 }
 
 GLuint FluidSimulator::getCurrentLevelSet() const{
-    return m_levelSetCurrent.texture;
+    return m_passGraph.getPersistentTexture(m_levelSet);
 }
 
-void FluidSimulator::resetLevelSet() const{
-    glBindTexture(GL_TEXTURE_3D, m_levelSetCurrent.texture);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, gridSize, gridSize, gridSize, 0, GL_RED, GL_FLOAT, m_initialLevelSetData.data());
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB32F, gridSize, gridSize, gridSize, 0, GL_RGB, GL_FLOAT, m_initialVelocityData.data());
+// Reduced-precision copy of the current level set, refreshed at the end of each integration step
+GLuint FluidSimulator::getRenderLevelSet() const{
+    return m_passGraph.getPersistentTexture(m_levelSetRender);
+}
+
+GLuint FluidSimulator::getDetailCoordinates() const{
+    return m_passGraph.getPersistentTexture(m_detailCoordinates);
+}
+
+GLuint FluidSimulator::getVelocity() const{
+    return m_passGraph.getPersistentTexture(m_velocity);
+}
+
+// Memory held by the simulation's texture pool, persistent quantities included
+std::size_t FluidSimulator::getTextureBytes() const{
+    return m_passGraph.getPoolBytes();
+}
+
+unsigned int FluidSimulator::getLevelSetGeneration() const{
+    return m_levelSetGeneration;
+}
+
+// Detail coordinates are only advected while the renderer uses them
+void FluidSimulator::setDetailAdvection(bool advectDetail){
+    if (advectDetail != m_advectDetail){
+        m_passGraphDeclared = false;
+    }
+    m_advectDetail = advectDetail;
+}
+
+// Replaces the level set the fluid starts from (and is reset to) with one of gridSize^3 values, and resets to it
+void FluidSimulator::setInitialLevelSet(std::vector<float> const& levelSet){
+    m_initialLevelSetData = levelSet;
+    resetLevelSet();
+}
+
+void FluidSimulator::resetLevelSet(){
+    ++m_levelSetGeneration;
+    m_passGraph.uploadPersistent(m_levelSet, m_initialLevelSetData);
+    m_passGraph.uploadPersistent(m_velocity, m_initialVelocityData);
+    m_passGraph.uploadPersistent(m_detailCoordinates, m_initialDetailCoordinatesData);
+    m_passGraph.uploadPersistent(m_previousDetailCoordinates, m_initialDetailCoordinatesData);
 }
 
 void FluidSimulator::updateAppliedForce(glm::vec3 force){
     m_appliedForce = force;
 }
 
-void FluidSimulator::initialiseUniforms(){
-    m_forceApplication.shader.useProgram();
-    uniformAppliedForce = m_forceApplication.shader.getUniformLocation("extForce");
-    glUniform3f(uniformAppliedForce, 0.0f, 0.0f, 0.0f);
-    uniformAppliedForcePosition = m_forceApplication.shader.getUniformLocation("extForcePos");
-    glUniform3f(uniformAppliedForce, 0.5f, 0.15f, 0.5f);
+// Read as each step runs, so changing them does not redeclare the integration step
+void FluidSimulator::setSolverIterations(int diffusionIterations, int pressureIterations){
+    m_numJacobiIterationsDiffusion = diffusionIterations;
+    m_numJacobiIterationsPressure = pressureIterations;
+}
+
+// Appends the rolling average GPU time of each stage of the integration, followed by the total
+void FluidSimulator::getStageTimes(std::vector<GPUStageTime>& stageTimes) const{
+    stageTimes.push_back({"Force", m_forceTimer.getAverageTime(), m_forceTimer.getMeanTime()});
+    stageTimes.push_back({"Velocity BC", m_boundaryTimer.getAverageTime(), m_boundaryTimer.getMeanTime()});
+    stageTimes.push_back({"Advection", m_advectionTimer.getAverageTime(), m_advectionTimer.getMeanTime()});
+    stageTimes.push_back({"Diffusion", m_diffusionTimer.getAverageTime(), m_diffusionTimer.getMeanTime()});
+    stageTimes.push_back({"Divergence", m_divergenceTimer.getAverageTime(), m_divergenceTimer.getMeanTime()});
+    stageTimes.push_back({"Pressure", m_pressureTimer.getAverageTime(), m_pressureTimer.getMeanTime()});
+    stageTimes.push_back({"Gradient", m_gradientTimer.getAverageTime(), m_gradientTimer.getMeanTime()});
+    stageTimes.push_back({"Level set", m_levelSetTimer.getAverageTime(), m_levelSetTimer.getMeanTime()});
+    stageTimes.push_back({"Simulation", m_integrationTimer.getAverageTime(), m_integrationTimer.getMeanTime()});
+}
+
+// GPU times of the whole integration step and of each Jacobi solver loop, from a recent frame
+SolverTimings FluidSimulator::getSolverTimings() const{
+    return SolverTimings{
+        m_integrationTimer.hasResult() && m_diffusionTimer.hasResult() && m_pressureTimer.hasResult(),
+        m_integrationTimer.getElapsedTime(),
+        m_diffusionTimer.getElapsedTime(),
+        m_pressureTimer.getElapsedTime()
+    };
 }
 
 void FluidSimulator::initialiseTextures(){
-    glActiveTexture(GL_TEXTURE0 + 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
     // Level set - initial surface at z = 0.5f
     // Takes the value of zero on air-water and box-water interfaces
     // ***Issue: Should be signed distance field, but using 0.5f outside due to pressure issue
@@ -76,246 +171,255 @@ void FluidSimulator::initialiseTextures(){
         }
     }
     
-    m_levelSetCurrent.generateTexture(m_initialLevelSetData, true);
-    m_levelSetNext.generateTexture(m_initialLevelSetData, true);
+    m_levelSet = m_passGraph.addPersistent(GL_R32F, m_initialLevelSetData);
+    m_previousAdvectedLevelSet = m_passGraph.addPersistent(GL_R32F, m_initialLevelSetData);
 
     // Velocity - initially zero everywhere
     m_initialVelocityData = std::vector<float>(4*gridSize*gridSize*gridSize, 0.0f);
-
-    m_velocityCurrent.generateTexture(m_initialVelocityData, false);
-    m_velocityNext.generateTexture(m_initialVelocityData, false);
+    m_velocity = m_passGraph.addPersistent(m_vectorFormat, m_initialVelocityData);
+    m_previousVelocityBC = m_passGraph.addPersistent(m_vectorFormat, m_initialVelocityData);
+    m_previousAdvectedVelocity = m_passGraph.addPersistent(m_vectorFormat, m_initialVelocityData);
     
     // Pressure - initially zero 
-    std::vector<float> tempPressureData(gridSize*gridSize*gridSize, 0.0f);
+    m_pressure = m_passGraph.addPersistent(GL_R32F, std::vector<float>(gridSize*gridSize*gridSize, 0.0f));
 
-    m_pressureCurrent.generateTexture(tempPressureData, true); // convert to scalar once m_tempVectorQuantity separated for vel/pressure
-    m_pressureNext.generateTexture(tempPressureData, true);
+    // Render copy of the level set - only the narrow band is kept, so R16 is ample
+    m_levelSetRender = m_passGraph.addPersistent(GL_R16, std::vector<float>(gridSize*gridSize*gridSize, 0.5f));
 
-    // Temporary set of buffers for use in Jacobi iteration
-    m_tempVectorQuantity.generateTexture(m_initialVelocityData, false);
-    m_tempScalarQuantity.generateTexture(tempPressureData, true);
+    // Detail coordinates - initially the texture coordinates of each cell
+    m_initialDetailCoordinatesData = std::vector<float>(3*gridSize*gridSize*gridSize, 0.0f);
+    for (int k = 0; k < gridSize; ++k){
+        for (int j = 0 ; j < gridSize; ++j){
+            for (int i = 0; i < gridSize; ++i){
+                int index = 3 * (gridSize * gridSize * k + gridSize * j + i);
+                m_initialDetailCoordinatesData[index] = (i + 0.5f) / gridSize;
+                m_initialDetailCoordinatesData[index + 1] = (j + 0.5f) / gridSize;
+                m_initialDetailCoordinatesData[index + 2] = (k + 0.5f) / gridSize;
+            }
+        }
+    }
+    m_detailCoordinates = m_passGraph.addPersistent(m_vectorFormat, m_initialDetailCoordinatesData);
+    m_previousDetailCoordinates = m_passGraph.addPersistent(m_vectorFormat, m_initialDetailCoordinatesData);
 }
 
-void FluidSimulator::initialiseFramebufferObjects(){
-    m_levelSetCurrent.generateFBOs();
-    m_levelSetNext.generateFBOs();
-    m_velocityCurrent.generateFBOs();
-    m_velocityNext.generateFBOs();
-    m_pressureCurrent.generateFBOs();
-    m_pressureNext.generateFBOs();
-    m_tempVectorQuantity.generateFBOs();
-    m_tempScalarQuantity.generateFBOs();
-}
+// Declares the integration step, which is rebuilt whenever its shape changes. Every write to a quantity gives a new
+// resource, and the graph allocates each one a texture from its pool. Inner passes write over the version of the
+// quantity whose boundary texels they should keep, which is the one that held their target texture before the step
+// used a pass graph. Returns false if the graph does not compile, in which case the step is not run
+bool FluidSimulator::buildPassGraph(){
+    m_passGraphDeclared = true;
+    using Resource = SlabPassGraph::Resource;
+    m_passGraph.clear();
+    Resource velocity = m_passGraph.importPersistent(m_velocity);
+    Resource previousVelocityBC = m_passGraph.importPersistent(m_previousVelocityBC);
+    Resource previousAdvectedVelocity = m_passGraph.importPersistent(m_previousAdvectedVelocity);
+    Resource levelSet = m_passGraph.importPersistent(m_levelSet);
+    Resource previousAdvectedLevelSet = m_passGraph.importPersistent(m_previousAdvectedLevelSet);
+    Resource pressure = m_passGraph.importPersistent(m_pressure);
 
-void FluidSimulator::integrateFluid(unsigned int frameTime){
-    glDisable(GL_BLEND);
-    glViewport(0,0,gridSize, gridSize);
-    glEnable(GL_SCISSOR_TEST);
-    
     // Apply force to velocity
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_3D, m_levelSetCurrent.texture);
-
-    m_forceApplication.shader.useProgram();
-    glUniform3fv(uniformAppliedForce, 1, glm::value_ptr(m_appliedForce));
-
-    applyInnerSlabOp(m_forceApplication, m_velocityNext, frameTime);
-    std::swap(m_velocityCurrent, m_velocityNext);
+    Resource forcedVelocity = addSlabPass("Force", m_forceApplication, &m_forceTimer, {{velocity, false}, {levelSet, false}}, m_vectorFormat, previousVelocityBC);
 
     // Velocity BC
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    applyOuterSlabOp(m_boundaryVelocity, m_velocityNext, frameTime);
-    std::swap(m_velocityCurrent, m_velocityNext);
-
-    // Advect Velocity
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    applyInnerSlabOp(m_advectionVelocity, m_velocityNext, frameTime);
+    velocity = addSlabPass("Velocity BC", m_boundaryVelocity, &m_boundaryTimer, {{forcedVelocity, true}}, m_vectorFormat);
 
-    // Advect Level Set using old velocity (but with corrected BC)
-    glBindTexture(GL_TEXTURE_3D, m_levelSetCurrent.texture);
-    applyInnerSlabOp(m_advectionLevelSet, m_levelSetNext, frameTime);
+    // Advect velocity
+    Resource advectedVelocity = addSlabPass("Advect velocity", m_advectionVelocity, &m_advectionTimer, {{velocity, false}, {velocity, true}}, m_vectorFormat, forcedVelocity);
 
-    // Put advected velocity in current
-    std::swap(m_velocityCurrent, m_velocityNext);
+    // Advect Level Set using old velocity (but with corrected BC)
+    Resource advectedLevelSet = addSlabPass("Advect level set", m_advectionLevelSet, &m_advectionTimer, {{velocity, false}, {levelSet, true}}, GL_R32F, previousAdvectedLevelSet);
+
+    // Advect detail coordinates in the same way
+    if (m_advectDetail){
+        Resource detailCoordinates = m_passGraph.importPersistent(m_detailCoordinates);
+        Resource previousDetailCoordinates = m_passGraph.importPersistent(m_previousDetailCoordinates);
+        Resource advectedDetailCoordinates = addSlabPass("Advect detail", m_advectionDetail, &m_advectionTimer, {{velocity, false}, {detailCoordinates, true}}, m_vectorFormat, previousDetailCoordinates);
+        m_passGraph.exportPersistent(advectedDetailCoordinates, m_detailCoordinates);
+        m_passGraph.exportPersistent(detailCoordinates, m_previousDetailCoordinates);
+    }
 
-    // Re-bind velocity    
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
+    // Pass through advected velocity, which is used as 0th iteration
+    Resource diffusedVelocity = addSlabPass("Pass through", m_passThrough, nullptr, {{advectedVelocity, false}}, m_vectorFormat, previousAdvectedVelocity);
 
-    // Pass through current velocity to temp velocity, which is used as 0th iteration
-    applyInnerSlabOp(m_passThrough, m_tempVectorQuantity, frameTime);
-    
-    // Re-bind velocity as quantity to be altered in pos = 2
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-
-    // Diffuse velocity
-    glActiveTexture(GL_TEXTURE0 + 0);
-    for (int i = 0; i < numJacobiIterationsDiffusion; ++i){
-        glBindTexture(GL_TEXTURE_3D, m_tempVectorQuantity.texture);
-        // Render into next velocity (kth iterate is in temp, k+1th in next)
-        applyInnerSlabOp(m_diffusion, m_velocityNext, frameTime);
-        // swap next and temp velocity, then iterate 
-        std::swap(m_velocityNext, m_tempVectorQuantity);
-        // Velocity BC - do we need to apply this every iteration?
-        glBindTexture(GL_TEXTURE_3D, m_tempVectorQuantity.texture);
-        applyOuterSlabOp(m_boundaryVelocity, m_velocityNext, frameTime);
-        std::swap(m_velocityNext, m_tempVectorQuantity);
-    }
-        
-    std::swap(m_velocityCurrent, m_tempVectorQuantity); // Swap final iteration into current velocity
+    // Diffuse velocity in place, using the texture of the velocity with the BC applied for the other iterate
+    diffusedVelocity = m_passGraph.addPass("Diffusion", &m_diffusionTimer, {{diffusedVelocity, true}}, m_vectorFormat, false,
+                                           [this](SlabPassGraph::Texture const& target, std::vector<SlabPassGraph::Texture const*> const& scratch){
+        iterateDiffusion(target, *scratch[0]);
+    }, {diffusedVelocity, velocity});
 
     // *Remove divergence from velocity*
 
     // Apply velocity BC (must be done to ensure correct divergence at bdries)
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    applyOuterSlabOp(m_boundaryVelocity, m_velocityNext, frameTime);
-    std::swap(m_velocityCurrent, m_velocityNext);
-
-    // Compute div of currentVelocity (store in textureVelocityTemp)
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    applyInnerSlabOp(m_divergence, m_tempScalarQuantity, frameTime);
-
-    /* // Clear pressure texture
-    applyOuterSlabOp(m_clearSlabs, m_pressureNext, frameTime);
-    std::swap(m_pressureCurrent, m_pressureNext); */
-
-    // Solve Poisson eqn 
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_3D, m_levelSetCurrent.texture);
-    for (int i = 0; i < numJacobiIterationsPressure; ++i){
-        // Pressure BC
-        glActiveTexture(GL_TEXTURE0 + 0);
-        glBindTexture(GL_TEXTURE_3D, m_pressureCurrent.texture);
-        applyOuterSlabOp(m_boundaryPressure, m_pressureNext, frameTime);
-        std::swap(m_pressureCurrent, m_pressureNext);
-
-        // Iteration (kth iteration in current, k+1th in next)
-        glActiveTexture(GL_TEXTURE0 + 0);
-        glBindTexture(GL_TEXTURE_3D, m_pressureCurrent.texture); // pressure
-        glActiveTexture(GL_TEXTURE0 + 2);
-        glBindTexture(GL_TEXTURE_3D, m_tempScalarQuantity.texture); // div(velocity)
-        applyInnerSlabOp(m_pressurePoisson, m_pressureNext, frameTime);
-        std::swap(m_pressureCurrent, m_pressureNext);
-    }
-
-    // Subtract grad(pressure) from currentVelocity
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_velocityCurrent.texture);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_3D, m_pressureCurrent.texture);
-    applyInnerSlabOp(m_removeDivergence, m_velocityNext, frameTime);
-    std::swap(m_velocityCurrent, m_velocityNext);
+    velocity = addSlabPass("Velocity BC", m_boundaryVelocity, &m_divergenceTimer, {{diffusedVelocity, true}}, m_vectorFormat);
 
-    //Level set BC
-    std::swap(m_levelSetCurrent, m_levelSetNext);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_3D, m_levelSetCurrent.texture);
-    applyOuterSlabOp(m_boundaryLevelSet, m_levelSetNext, frameTime);
-    std::swap(m_levelSetCurrent, m_levelSetNext);
+    // Compute div of velocity
+    Resource divergence = addSlabPass("Divergence", m_divergence, &m_divergenceTimer, {{velocity, true}}, GL_R32F);
 
-    // Tidy up
-    glDisable(GL_SCISSOR_TEST);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glEnable(GL_BLEND);
+    // Solve Poisson eqn in place, starting from the previous step's pressure
+    pressure = m_passGraph.addPass("Pressure", &m_pressureTimer, {{pressure, true}, {levelSet, false}, {divergence, false}}, GL_R32F, false,
+                                   [this](SlabPassGraph::Texture const& target, std::vector<SlabPassGraph::Texture const*> const& scratch){
+        iteratePressure(target, *scratch[0]);
+    }, {pressure}, 1);
+
+    // Subtract grad(pressure) from velocity
+    Resource projectedVelocity = addSlabPass("Gradient", m_removeDivergence, &m_gradientTimer, {{velocity, false}, {pressure, true}}, m_vectorFormat, diffusedVelocity);
+
+    //Level set BC
+    levelSet = addSlabPass("Level set BC", m_boundaryLevelSet, &m_levelSetTimer, {{advectedLevelSet, true}}, GL_R32F);
+
+    // Render copy of the level set
+    Resource levelSetRender = addSlabPass("Encode level set", m_encodeLevelSet, &m_levelSetTimer, {{levelSet, true}}, GL_R16);
+
+    m_passGraph.exportPersistent(projectedVelocity, m_velocity);
+    m_passGraph.exportPersistent(velocity, m_previousVelocityBC);
+    m_passGraph.exportPersistent(advectedVelocity, m_previousAdvectedVelocity);
+    m_passGraph.exportPersistent(levelSet, m_levelSet);
+    m_passGraph.exportPersistent(advectedLevelSet, m_previousAdvectedLevelSet);
+    m_passGraph.exportPersistent(pressure, m_pressure);
+    m_passGraph.exportPersistent(levelSetRender, m_levelSetRender);
+    return m_passGraph.compile();
 }
 
-// Generates a new 3D floating-point texture with the given input as the initial data
-void FluidSimulator::SimulatedQuantity::generateTexture(std::vector<float> data, bool scalarQuantity = false){
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_3D, texture);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    if (!scalarQuantity){
-        glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB32F, gridSize, gridSize, gridSize, 0, GL_RGB, GL_FLOAT, data.data());
+// The kth iterate is in velocity. The k+1th is written over the k-1th in scratch, then has the BC applied back into velocity
+void FluidSimulator::iterateDiffusion(SlabPassGraph::Texture const& velocity, SlabPassGraph::Texture const& scratch) const{
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    for (int i = 0; i < m_numJacobiIterationsDiffusion; ++i){
+        GLStateCache::bindTexture(GL_TEXTURE_3D, velocity.texture);
+        applyInnerSlabOp(m_diffusion, scratch);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, scratch.texture);
+        applyOuterSlabOp(m_boundaryVelocity, velocity);
     }
-    else{
-        glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, gridSize, gridSize, gridSize, 0, GL_RED, GL_FLOAT, data.data());
+}
+
+// The kth iterate is in pressure. It has the BC applied into scratch, and the k+1th is written over it in pressure.
+// The level set and divergence are already bound to texture units 1 and 2
+void FluidSimulator::iteratePressure(SlabPassGraph::Texture const& pressure, SlabPassGraph::Texture const& scratch) const{
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    for (int i = 0; i < m_numJacobiIterationsPressure; ++i){
+        GLStateCache::bindTexture(GL_TEXTURE_3D, pressure.texture);
+        applyOuterSlabOp(m_boundaryPressure, scratch);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, scratch.texture);
+        applyInnerSlabOp(m_pressurePoisson, pressure);
     }
-    glBindTexture(GL_TEXTURE_3D, 0);
 }
 
-// Generates an array of FBOs for using slab operations to render into the simulated quantity texture
-void FluidSimulator::SimulatedQuantity::generateFBOs(){
-    for (int zSlice = 0; zSlice < gridSize; ++zSlice){
-        glGenFramebuffers(1, &(slabFBOs[zSlice]));
-        glBindFramebuffer(GL_FRAMEBUFFER, slabFBOs[zSlice]);
-        glFramebufferTexture3D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_3D, texture, 0, zSlice);
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-                throw std::runtime_error("Failed to initialise framebuffer\n");
+void FluidSimulator::integrateFluid(unsigned int frameTime){
+    if (!m_passGraphDeclared){
+        buildPassGraph();
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_integrationTimer.begin();
+    m_sharedConstants.update(frameTime, m_appliedForce);
+    GLStateCache::disable(GL_BLEND);
+    GLStateCache::viewport(0,0,gridSize, gridSize);
+    GLStateCache::enable(GL_SCISSOR_TEST);
+
+    m_passGraph.execute();
+    ++m_levelSetGeneration; // The render copy of the level set was republished
+
+    // Tidy up
+    GLStateCache::disable(GL_SCISSOR_TEST);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::enable(GL_BLEND);
+    m_integrationTimer.end();
 }
 
-FluidSimulator::SlabOperation::SlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames) :
-    shader(vertexShaderPath, fragmentShaderPath)
+FluidSimulator::SlabOperation::SlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines) :
+    shader(vertexShaderPath, sliceGeometryShader(), fragmentShaderPath, {}, sliceDefines(defines)), textureNames{textureNames}
 {   
-    shader.useProgram();
-
-    // Model matrix
-    quadUniforms.m_modelTransformation = shader.getUniformLocation("model");
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::scale(model, glm::vec3(gridSize, gridSize, 1));
-    model = glm::translate(model, glm::vec3(0.0f,0.0f,0.0f));
-    glUniformMatrix4fv(quadUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
+}
 
-    // Projection matrix
-    glm::mat4 projection = glm::ortho(0.0f, (float)gridSize,  0.0f, (float)gridSize, -1.0f, 1.0f);
-    quadUniforms.m_projectionTransformation = shader.getUniformLocation("projection");
-    glUniformMatrix4fv(quadUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
-    
+// Waits for the program to build, so is left until every program has been issued
+void FluidSimulator::SlabOperation::initialiseUniforms(){
+    shader.useProgram();
+    shader.bindUniformBlock("GridConstants", m_gridConstantsBinding);
+    shader.bindUniformBlock("FrameConstants", m_frameConstantsBinding);
     for (unsigned int i = 0 ; i < textureNames.size() ; ++i){
         if (textureNames[i].length() != 0){
             glUniform1i(shader.getUniformLocation(textureNames[i]), i);
         }
     }
+    uniformSlice = shader.getUniformLocation(sliceUniform());
 }
 
-FluidSimulator::InnerSlabOperation::InnerSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames) : 
-    SlabOperation(vertexShaderPath, fragmentShaderPath, textureNames)
+FluidSimulator::InnerSlabOperation::InnerSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines) : 
+    SlabOperation(vertexShaderPath, fragmentShaderPath, textureNames, defines)
 {
-    uniformZSlice = shader.getUniformLocation("zSlice");
-    uniformTimeStep = shader.getUniformLocation("timeStep");
 }
 
-FluidSimulator::OuterSlabOperation::OuterSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames) : 
-    SlabOperation(vertexShaderPath, fragmentShaderPath, textureNames)
+FluidSimulator::OuterSlabOperation::OuterSlabOperation(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, std::vector<std::string> const& textureNames, std::vector<std::string> const& defines) : 
+    SlabOperation(vertexShaderPath, fragmentShaderPath, textureNames, defines)
 {
-    uniformZSlice = shader.getUniformLocation("zSlice");
 }
 
-void FluidSimulator::applySlabOp(SlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime, int layerFrom, int layerTo) const{
+// The grid constants never change, so are uploaded once. Both buffers stay bound to their binding points throughout
+FluidSimulator::SharedConstants::SharedConstants(){
+    glGenBuffers(1, &gridConstantsUBO);
+    glGenBuffers(1, &frameConstantsUBO);
+
+    // Maps the unit quad to a slab covering the grid
+    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(gridSize, gridSize, 1));
+    glm::mat4 projection = glm::ortho(0.0f, (float)gridSize,  0.0f, (float)gridSize, -1.0f, 1.0f);
+    glm::mat4 slabTransform = projection * model;
+    glBindBuffer(GL_UNIFORM_BUFFER, gridConstantsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), glm::value_ptr(slabTransform), GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameConstantsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_gridConstantsBinding, gridConstantsUBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_frameConstantsBinding, frameConstantsUBO);
+}
+
+FluidSimulator::SharedConstants::~SharedConstants(){
+    glDeleteBuffers(1, &gridConstantsUBO);
+    glDeleteBuffers(1, &frameConstantsUBO);
+}
+
+void FluidSimulator::SharedConstants::update(unsigned int frameTime, glm::vec3 appliedForce) const{
+    FrameConstants frameConstants{(float)frameTime, {}, glm::vec4(appliedForce, 0.0f)};
+    glBindBuffer(GL_UNIFORM_BUFFER, frameConstantsUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &frameConstants);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Program and VAO binds are elided by GLStateCache when consecutive operations share them
+void FluidSimulator::applySlabOp(SlabOperation const& slabOp, SlabPassGraph::Texture const& target, int layerFrom, int layerTo) const{
     m_quad.bindVAO();
     slabOp.shader.useProgram();
-    glUniform1f(slabOp.uniformTimeStep, (float)frameTime);
+    if (Capabilities::slicePath() != Capabilities::SlicePath::perSlice){
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, target.layeredFBO);
+        glUniform1i(slabOp.uniformSlice, layerFrom);
+        m_quad.drawInstanced(GL_TRIANGLES, layerTo - layerFrom);
+        return;
+    }
     for (int zSlice = layerFrom; zSlice < layerTo; ++zSlice){
-        glBindFramebuffer(GL_FRAMEBUFFER, quantity.slabFBOs[zSlice]);
-        glUniform1f(slabOp.uniformZSlice, (float)zSlice);
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, target.slabFBOs[zSlice]);
+        glUniform1f(slabOp.uniformSlice, (float)zSlice);
         m_quad.draw(GL_TRIANGLES);
     }
 }
 
-void FluidSimulator::applyInnerSlabOp(InnerSlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime) const{
-    glScissor(1,1,gridSize-2,gridSize-2);
-    applySlabOp(slabOp, quantity, frameTime, 1, gridSize-1);
+void FluidSimulator::applyInnerSlabOp(InnerSlabOperation const& slabOp, SlabPassGraph::Texture const& target) const{
+    GLStateCache::scissor(1,1,gridSize-2,gridSize-2);
+    applySlabOp(slabOp, target, 1, gridSize-1);
 }
 
-void FluidSimulator::applyOuterSlabOp(OuterSlabOperation const& slabOp, SimulatedQuantity const& quantity, unsigned int frameTime) const{
+void FluidSimulator::applyOuterSlabOp(OuterSlabOperation const& slabOp, SlabPassGraph::Texture const& target) const{
     // Issue: probably more efficient to render four quads
-    glScissor(0,0,gridSize,gridSize);
-    applySlabOp(slabOp, quantity, frameTime, 0, gridSize);
+    GLStateCache::scissor(0,0,gridSize,gridSize);
+    applySlabOp(slabOp, target, 0, gridSize);
+}
+
+SlabPassGraph::Resource FluidSimulator::addSlabPass(char const* name, InnerSlabOperation const& slabOp, GPUTimer* stage, std::vector<SlabPassGraph::Input> const& inputs, GLint outputFormat, SlabPassGraph::Resource writesOver){
+    return m_passGraph.addPass(name, stage, inputs, outputFormat, false, [this, &slabOp](SlabPassGraph::Texture const& target, std::vector<SlabPassGraph::Texture const*> const&){
+        applyInnerSlabOp(slabOp, target);
+    }, writesOver == -1 ? std::vector<SlabPassGraph::Resource>{} : std::vector<SlabPassGraph::Resource>{writesOver});
+}
+
+SlabPassGraph::Resource FluidSimulator::addSlabPass(char const* name, OuterSlabOperation const& slabOp, GPUTimer* stage, std::vector<SlabPassGraph::Input> const& inputs, GLint outputFormat){
+    return m_passGraph.addPass(name, stage, inputs, outputFormat, true, [this, &slabOp](SlabPassGraph::Texture const& target, std::vector<SlabPassGraph::Texture const*> const&){
+        applyOuterSlabOp(slabOp, target);
+    });
 }
 
 FluidRenderer::FluidRenderer(unsigned int width, unsigned int height) : 
@@ -324,13 +428,27 @@ FluidRenderer::FluidRenderer(unsigned int width, unsigned int height) :
     m_camera(m_cameraIntialPos),
     m_frontCube{width, height},
     m_backCube{width, height},
-    m_backgroundPlaneShader{".//shaders//background_plane.vert", ".//shaders//background_plane.frag"},
+    m_fluidTarget{width, height, GL_RGBA, true},
+    m_renderWidth{width}, m_renderHeight{height},
+    m_resolutionGovernor{m_fluidFrameBudget, m_minRenderScale, 1.0f},
+    m_backgroundPlaneShader{".//shaders//background_plane.vert", ".//shaders//background_plane.frag", shaderDefines()},
     m_raycastingPosShader(".//shaders//raycasting_pos.vert", ".//shaders//raycasting_pos.frag"),
-    m_renderFluidShader(".//shaders//fluid.vert", ".//shaders//fluid.frag")
+    m_compositeFluidShader(".//shaders//fluid.vert", ".//shaders//composite_fluid.frag"),
+    m_extractSurfaceShader(".//shaders//marching_cubes.vert", ".//shaders//marching_cubes.geom", "", {"meshPosition", "meshNormal"}, shaderDefines()),
+    m_renderMeshShader(".//shaders//fluid_mesh.vert", ".//shaders//fluid_mesh.frag", shaderDefines()),
+    m_reduceHeightfieldShader(".//shaders//fluid.vert", ".//shaders//heightfield_reduce.frag", shaderDefines()),
+    m_renderHeightfieldShader(".//shaders//heightfield.vert", ".//shaders//fluid_mesh.frag", shaderDefines()),
+    m_computeTransmittanceShader(".//shaders//fluid.vert", sliceGeometryShader(), ".//shaders//compute_transmittance.frag", {}, sliceDefines()),
+    m_bakeEnvironmentShader(".//shaders//fluid.vert", ".//shaders//bake_environment.frag", shaderDefines()),
+    m_multiViewShader(".//shaders//multiview.vert", ".//shaders//multiview.geom", ".//shaders//multiview.frag", {}, shaderDefines()),
+    m_computeNormalsShader(".//shaders//fluid.vert", sliceGeometryShader(), ".//shaders//compute_normals.frag", {}, sliceDefines()),
+    m_computeOccupancyShader(".//shaders//fluid.vert", sliceGeometryShader(), ".//shaders//compute_occupancy.frag", {}, sliceDefines()),
+    m_renderFluidShader(".//shaders//fluid.vert", ".//shaders//fluid.frag", {"CELL_TRAVERSAL"}, shaderDefines({"TRICUBIC_NORMALS 1"})),
+    m_upsampleLevelSetShader(".//shaders//fluid.vert", ".//shaders//upsample_level_set.frag", {"ADD_DETAIL"}, sliceDefines(), sliceGeometryShader())
 {
     try{
         initialiseShaders();
-        setUpSkybox();
+        bakeEnvironment();
         m_successfullyInitialised = true;
     }
     catch (std::exception const& e){
@@ -350,17 +468,224 @@ void FluidRenderer::updateCamera(float cameraHorizontalRotation, float cameraVer
     }
 }
 
-void FluidRenderer::render(GLuint currentLevelSetTexture) const{
-    glDisable(GL_CULL_FACE); // Check...
-    glViewport(0,0,m_screenWidth,m_screenHeight);
+void FluidRenderer::render(GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration){
+    TRACE_SCOPE("FluidRenderer::render");
+    m_renderTimer.begin();
+    if (!m_environmentProbe.valid){
+        bakeEnvironment();
+    }
+    m_volumesTimer.begin();
+    updateVolumes(simulationLevelSetTexture, detailCoordinatesTexture, levelSetGeneration);
+    m_volumesTimer.end();
+    // Unit 6 is reserved for the transmittance volume for the rest of the frame
+    GLStateCache::activeTexture(GL_TEXTURE0 + 6);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_transmittance.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLuint const currentLevelSetTexture = m_upsampledLevelSet.texture;
+    bool const useHeightfield = m_surfaceMode == SurfaceMode::rayMarching && m_heightfieldFastPath;
+    m_surfaceTimer.begin();
+    if (m_surfaceMode == SurfaceMode::marchingCubes){
+        extractSurface(currentLevelSetTexture);
+    }
+    else if (useHeightfield){
+        reduceHeightfield(currentLevelSetTexture);
+    }
+    m_surfaceTimer.end();
+    GLStateCache::disable(GL_CULL_FACE); // Check...
+    GLStateCache::viewport(0,0,m_screenWidth,m_screenHeight);
+    m_backgroundTimer.begin();
     renderBackground();
-    renderFluid(currentLevelSetTexture);
+    m_backgroundTimer.end();
+    m_renderFluidTimer.begin();
+    if (m_surfaceMode == SurfaceMode::marchingCubes){
+        m_surfaceMesh.collect();
+    }
+    if (m_surfaceMode == SurfaceMode::marchingCubes && m_surfaceMesh.complete){
+        renderSurfaceMesh(currentLevelSetTexture);
+    }
+    else if (useHeightfield && m_heightfield.framesWithoutOverhangs >= m_heightfieldHysteresis){
+        renderHeightfield(currentLevelSetTexture);
+    }
+    else{
+        renderFluid(currentLevelSetTexture);
+    }
+    m_renderFluidTimer.end();
+    m_compositeTimer.begin();
+    compositeFluid();
+    m_compositeTimer.end();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 6);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    m_renderTimer.end();
+    updateRenderResolution();
 }
 
 bool FluidRenderer::successfullyInitialised() const {
     return m_successfullyInitialised;
 }
 
+// GPU time of a recent call to render(), in ms
+float FluidRenderer::getRenderTime() const{
+    return m_renderTimer.getElapsedTime();
+}
+
+// Appends the rolling average GPU time of each pass of render(), followed by the total
+void FluidRenderer::getStageTimes(std::vector<GPUStageTime>& stageTimes) const{
+    stageTimes.push_back({"Volumes", m_volumesTimer.getAverageTime(), m_volumesTimer.getMeanTime()});
+    stageTimes.push_back({"Surface", m_surfaceTimer.getAverageTime(), m_surfaceTimer.getMeanTime()});
+    stageTimes.push_back({"Background", m_backgroundTimer.getAverageTime(), m_backgroundTimer.getMeanTime()});
+    stageTimes.push_back({"Fluid", m_renderFluidTimer.getAverageTime(), m_renderFluidTimer.getMeanTime()});
+    stageTimes.push_back({"Composite", m_compositeTimer.getAverageTime(), m_compositeTimer.getMeanTime()});
+    stageTimes.push_back({"Render", m_renderTimer.getAverageTime(), m_renderTimer.getMeanTime()});
+}
+
+void FluidRenderer::toggleSurfaceMode(){
+    if (m_surfaceMode == SurfaceMode::rayMarching){
+        m_surfaceMode = SurfaceMode::marchingCubes;
+        m_surfaceMesh.reset();
+        std::cout << "Surface mode: marching cubes\n";
+    }
+    else{
+        m_surfaceMode = SurfaceMode::rayMarching;
+        std::cout << "Surface mode: ray marching\n";
+    }
+}
+
+void FluidRenderer::toggleHeightfieldFastPath(){
+    m_heightfieldFastPath = !m_heightfieldFastPath;
+    m_heightfield.framesWithoutOverhangs = 0;
+    std::cout << "Heightfield fast path: " << (m_heightfieldFastPath ? "enabled" : "disabled") << "\n";
+}
+
+void FluidRenderer::toggleCellTraversal(){
+    m_cellTraversal = !m_cellTraversal;
+    std::cout << "Ray marching: " << (m_cellTraversal ? "exact cell traversal" : "fixed step") << "\n";
+}
+
+// Without adaptive resolution the fluid is always ray marched at full resolution, e.g. for benchmarking
+void FluidRenderer::setAdaptiveResolution(bool adaptive){
+    m_adaptiveResolution = adaptive;
+}
+
+void FluidRenderer::setLevelSetDetail(bool addDetail){
+    m_levelSetDetail = addDetail;
+    m_volumesValid = false;
+}
+
+// Renders the scene from each camera into a layer of the views texture, in passes of up to maxViewsPerPass views. The
+// volumes are shared by all views, and the result is queued for asynchronous readback with readViews()
+void FluidRenderer::renderViews(std::vector<glm::mat4> const& viewMatrices, unsigned int width, unsigned int height,
+                                GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration){
+    if (viewMatrices.empty()){
+        return;
+    }
+    if (!m_environmentProbe.valid){
+        bakeEnvironment();
+    }
+    updateVolumes(simulationLevelSetTexture, detailCoordinatesTexture, levelSetGeneration);
+    if (!m_viewVolumesValid){
+        GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, m_upsampledLevelSet.texture);
+        m_computeNormalsShader.useProgram();
+        renderVolume(m_normals, m_uniformSliceNormals);
+        m_computeOccupancyShader.useProgram();
+        renderVolume(m_occupancy, m_uniformSliceOccupancy);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+        m_viewVolumesValid = true;
+    }
+    m_multiView.resize(width, height, viewMatrices.size());
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width/(float)height, 0.1f, 100.0f);
+    std::vector<glm::mat4> inverseViewProjections;
+    std::vector<glm::vec3> cameraPositions;
+    for (glm::mat4 const& view : viewMatrices){
+        inverseViewProjections.push_back(glm::inverse(projection * view));
+        cameraPositions.push_back(glm::vec3(glm::inverse(view)[3]) / m_cubeScale + glm::vec3(0.5f, 0.5f, 0.5f));
+    }
+
+    GLStateCache::viewport(0, 0, width, height);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_multiView.FBO);
+    GLStateCache::disable(GL_BLEND);
+    m_multiViewShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_upsampledLevelSet.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_normals.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_occupancy.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 5);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.environmentTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 6);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_transmittance.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 7);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.floorTexture);
+    GLStateCache::bindVertexArray(m_multiView.VAO);
+    for (unsigned int first = 0 ; first < viewMatrices.size() ; first += MultiViewTarget::maxViewsPerPass){
+        GLsizei count = std::min<GLsizei>(MultiViewTarget::maxViewsPerPass, viewMatrices.size() - first);
+        glUniform1i(m_uniformFirstLayerMultiView, first);
+        glUniformMatrix4fv(m_uniformInverseViewProjections, count, GL_FALSE, glm::value_ptr(inverseViewProjections[first]));
+        glUniform3fv(m_uniformCameraPositions, count, glm::value_ptr(cameraPositions[first]));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 3, count);
+    }
+    GLStateCache::bindVertexArray(0);
+
+    // Tidy up texture bindings
+    GLStateCache::activeTexture(GL_TEXTURE0 + 6);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::enable(GL_BLEND);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+
+    // Queue the readback of every layer. An older result that was never read is replaced
+    unsigned int const current = m_multiView.current;
+    if (m_multiView.fences[current]){
+        glDeleteSync(m_multiView.fences[current]);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_multiView.PBOs[current]);
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, m_multiView.texture);
+    glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_multiView.fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_multiView.current = 1 - current;
+}
+
+// Copies out the oldest queued views as RGBA8, layer by layer with rows bottom to top. Unless waiting, returns false
+// without blocking if the GPU has not finished them
+bool FluidRenderer::readViews(std::vector<unsigned char>& pixels, bool wait){
+    unsigned int oldest = m_multiView.fences[m_multiView.current] ? m_multiView.current : 1 - m_multiView.current;
+    GLsync& fence = m_multiView.fences[oldest];
+    if (!fence){
+        return false;
+    }
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED){
+        return false;
+    }
+    glDeleteSync(fence);
+    fence = 0;
+
+    std::size_t const size = 4 * static_cast<std::size_t>(m_multiView.width) * m_multiView.height * m_multiView.layers;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_multiView.PBOs[oldest]);
+    unsigned char const* result = static_cast<unsigned char const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    if (result){
+        pixels.assign(result, result + size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return result != nullptr;
+}
+
+GLuint FluidRenderer::getViewsTexture() const{
+    return m_multiView.texture;
+}
+
 void FluidRenderer::initialiseShaders(){
     // Get uniform locations and set values for raycastingPosShader
     m_raycastingPosShader.useProgram();
@@ -401,59 +726,178 @@ void FluidRenderer::initialiseShaders(){
     m_backgroundPlaneUniforms.m_viewTransformation = m_backgroundPlaneShader.getUniformLocation("view");
     glUniformMatrix4fv(m_backgroundPlaneUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
 
-    // Get uniform locations and set values for renderFluidShader - note symmetry with above (can we condense?)
-    m_renderFluidShader.useProgram();
-
-    // Model matrix
-    m_renderFluidUniforms.m_modelTransformation = m_renderFluidShader.getUniformLocation("model");
+    // Get uniform locations and set values for each variant of renderFluidShader - note symmetry with above (can we condense?)
     model = glm::mat4(1.0f);
     model = glm::scale(model, glm::vec3(m_screenWidth, m_screenHeight, 1)); 
     model = glm::translate(model, glm::vec3(0, 0, 0.0f));
-    glUniformMatrix4fv(m_renderFluidUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
-
-    // Projection matrix
     projection = glm::ortho(0.0f, (float)m_screenWidth,  0.0f, (float)m_screenHeight, -1.0f, 1.0f);
-    m_renderFluidUniforms.m_projectionTransformation = m_renderFluidShader.getUniformLocation("projection");
-    glUniformMatrix4fv(m_renderFluidUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
-
-    // No view matrix required in orthogonal projection
+    setUpSplines(); // For use in tri-cubic interpolation of normals
+    for (unsigned int i = 0 ; i < m_renderFluidShader.size() ; ++i){
+        ShaderProgram const& shader = m_renderFluidShader[i];
+        shader.useProgram();
+
+        // Model and projection matrices - no view matrix required in orthogonal projection
+        m_renderFluidUniforms.m_modelTransformation = shader.getUniformLocation("model");
+        glUniformMatrix4fv(m_renderFluidUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
+        m_renderFluidUniforms.m_projectionTransformation = shader.getUniformLocation("projection");
+        glUniformMatrix4fv(m_renderFluidUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
+
+        // Set up uniforms for 'cube vector' textures
+        m_frontCube.uniformTexture =  shader.getUniformLocation("frontTexture");
+        m_backCube.uniformTexture = shader.getUniformLocation("backTexture");
+        glUniform1i(m_frontCube.uniformTexture, 0);
+        glUniform1i(m_backCube.uniformTexture, 1);
+
+        // Set up uniforms for level set and spline textures
+        m_uniformLevelSetFluid = shader.getUniformLocation("levelSetTexture");
+        glUniform1i(m_uniformLevelSetFluid, 2);
+        m_uniformSplineTexture = shader.getUniformLocation("splineTexture");
+        glUniform1i(m_uniformSplineTexture, 3);
+        m_uniformSplineDerivTexture = shader.getUniformLocation("splineDerivTexture");
+        glUniform1i(m_uniformSplineDerivTexture, 4);
+    }
 
-    // Set up uniforms for 'cube vector' textures
-    m_frontCube.uniformTexture =  m_renderFluidShader.getUniformLocation("frontTexture");
-    m_backCube.uniformTexture = m_renderFluidShader.getUniformLocation("backTexture");
-    m_renderFluidShader.useProgram();
-    glUniform1i(m_frontCube.uniformTexture, 0);
-    glUniform1i(m_backCube.uniformTexture, 1);
+    setUpSkybox();
 
-    // Set up uniform for level set texture
-    m_uniformLevelSetFluid = m_renderFluidShader.getUniformLocation("levelSetTexture");
-    glUniform1i(m_uniformLevelSetFluid, 2);
+    // Get uniform locations and set values for compositeFluidShader - covers the screen in the same way as above
+    m_compositeFluidShader.useProgram();
+    m_compositeFluidUniforms.m_modelTransformation = m_compositeFluidShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_compositeFluidUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
+    m_compositeFluidUniforms.m_projectionTransformation = m_compositeFluidShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_compositeFluidUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
+    m_fluidTarget.uniformTexture = m_compositeFluidShader.getUniformLocation("fluidTexture");
+    glUniform1i(m_fluidTarget.uniformTexture, 0);
+
+    // Marching cubes extraction samples the level set and the triangle table
+    m_extractSurfaceShader.useProgram();
+    glUniform1i(m_extractSurfaceShader.getUniformLocation("levelSetTexture"), 0);
+    glUniform1i(m_extractSurfaceShader.getUniformLocation("triangleTable"), 1);
+
+    // Get uniform locations and set values for renderMeshShader - the mesh occupies the same space as the cube
+    m_renderMeshShader.useProgram();
+    m_renderMeshUniforms.m_modelTransformation = m_renderMeshShader.getUniformLocation("model");
+    model = glm::scale(glm::mat4(1.0f), glm::vec3(m_cubeScale, m_cubeScale, m_cubeScale));
+    glUniformMatrix4fv(m_renderMeshUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
+    m_renderMeshUniforms.m_projectionTransformation = m_renderMeshShader.getUniformLocation("projection");
+    projection = glm::perspective(glm::radians(45.0f), (float)m_screenWidth/(float)m_screenHeight, 0.1f, 100.0f);
+    glUniformMatrix4fv(m_renderMeshUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
+    m_renderMeshUniforms.m_viewTransformation = m_renderMeshShader.getUniformLocation("view");
+    glUniformMatrix4fv(m_renderMeshUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
+    m_uniformCameraPositionMesh = m_renderMeshShader.getUniformLocation("cameraPosition");
+    glUniform1i(m_renderMeshShader.getUniformLocation("levelSetTexture"), 2);
+
+    // Heightfield reduction covers the renderGridSize x renderGridSize target with a single quad
+    m_reduceHeightfieldShader.useProgram();
+    m_reduceHeightfieldUniforms.m_modelTransformation = m_reduceHeightfieldShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_reduceHeightfieldUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    m_reduceHeightfieldUniforms.m_projectionTransformation = m_reduceHeightfieldShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_reduceHeightfieldUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+    glUniform1i(m_reduceHeightfieldShader.getUniformLocation("levelSetTexture"), 0);
+
+    // The displaced grid shares the mesh shading, so uses the same transformations and texture units
+    m_renderHeightfieldShader.useProgram();
+    m_renderHeightfieldUniforms.m_modelTransformation = m_renderHeightfieldShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_renderHeightfieldUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(model));
+    m_renderHeightfieldUniforms.m_projectionTransformation = m_renderHeightfieldShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_renderHeightfieldUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(projection));
+    m_renderHeightfieldUniforms.m_viewTransformation = m_renderHeightfieldShader.getUniformLocation("view");
+    glUniformMatrix4fv(m_renderHeightfieldUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
+    m_uniformCameraPositionHeightfield = m_renderHeightfieldShader.getUniformLocation("cameraPosition");
+    glUniform1i(m_renderHeightfieldShader.getUniformLocation("heightfieldTexture"), 0);
+    glUniform1i(m_renderHeightfieldShader.getUniformLocation("levelSetTexture"), 2);
+
+    // Level set upsampling covers each renderGridSize x renderGridSize slab with a single quad
+    for (unsigned int i = 0 ; i < m_upsampleLevelSetShader.size() ; ++i){
+        ShaderProgram const& shader = m_upsampleLevelSetShader[i];
+        shader.useProgram();
+        m_upsampleLevelSetUniforms.m_modelTransformation = shader.getUniformLocation("model");
+        glUniformMatrix4fv(m_upsampleLevelSetUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        m_upsampleLevelSetUniforms.m_projectionTransformation = shader.getUniformLocation("projection");
+        glUniformMatrix4fv(m_upsampleLevelSetUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+        glUniform1i(shader.getUniformLocation("levelSetTexture"), 0);
+        glUniform1i(shader.getUniformLocation("detailCoordinatesTexture"), 1);
+        glUniform1i(shader.getUniformLocation("splineTexture"), 3);
+        m_uniformSliceUpsample.push_back(shader.getUniformLocation(sliceUniform()));
+    }
 
-    setUpSplines(); // For use in tri-cubic interpolation of normals
-    m_uniformSplineTexture = m_renderFluidShader.getUniformLocation("splineTexture");
-    glUniform1i(m_uniformSplineTexture, 3);
-    m_uniformSplineDerivTexture = m_renderFluidShader.getUniformLocation("splineDerivTexture");
-    glUniform1i(m_uniformSplineDerivTexture, 4);
+    // Transmittance is computed in the same way, from the upsampled level set
+    m_computeTransmittanceShader.useProgram();
+    m_computeTransmittanceUniforms.m_modelTransformation = m_computeTransmittanceShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_computeTransmittanceUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    m_computeTransmittanceUniforms.m_projectionTransformation = m_computeTransmittanceShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_computeTransmittanceUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+    glUniform1i(m_computeTransmittanceShader.getUniformLocation("levelSetTexture"), 0);
+    m_uniformSliceTransmittance = m_computeTransmittanceShader.getUniformLocation(sliceUniform());
+
+    // The environment probe is baked with a quad over each face
+    m_bakeEnvironmentShader.useProgram();
+    m_bakeEnvironmentUniforms.m_modelTransformation = m_bakeEnvironmentShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_bakeEnvironmentUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    m_bakeEnvironmentUniforms.m_projectionTransformation = m_bakeEnvironmentShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_bakeEnvironmentUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+    glUniform1i(m_bakeEnvironmentShader.getUniformLocation("skyBoxTexture"), 0);
+    m_uniformFaceBake = m_bakeEnvironmentShader.getUniformLocation("face");
+
+    // Normals and occupancy are computed for each slab in the same way as the other volumes
+    m_computeNormalsShader.useProgram();
+    m_computeNormalsUniforms.m_modelTransformation = m_computeNormalsShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_computeNormalsUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    m_computeNormalsUniforms.m_projectionTransformation = m_computeNormalsShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_computeNormalsUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+    glUniform1i(m_computeNormalsShader.getUniformLocation("levelSetTexture"), 0);
+    m_uniformSliceNormals = m_computeNormalsShader.getUniformLocation(sliceUniform());
+
+    m_computeOccupancyShader.useProgram();
+    m_computeOccupancyUniforms.m_modelTransformation = m_computeOccupancyShader.getUniformLocation("model");
+    glUniformMatrix4fv(m_computeOccupancyUniforms.m_modelTransformation, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    m_computeOccupancyUniforms.m_projectionTransformation = m_computeOccupancyShader.getUniformLocation("projection");
+    glUniformMatrix4fv(m_computeOccupancyUniforms.m_projectionTransformation, 1, GL_FALSE, glm::value_ptr(glm::ortho(0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f)));
+    glUniform1i(m_computeOccupancyShader.getUniformLocation("levelSetTexture"), 0);
+    m_uniformSliceOccupancy = m_computeOccupancyShader.getUniformLocation(sliceUniform());
+
+    // Multi-view rendering computes its camera rays from per-view uniforms
+    m_multiViewShader.useProgram();
+    glUniform1i(m_multiViewShader.getUniformLocation("levelSetTexture"), 0);
+    glUniform1i(m_multiViewShader.getUniformLocation("normalTexture"), 1);
+    glUniform1i(m_multiViewShader.getUniformLocation("occupancyTexture"), 2);
+    m_uniformFirstLayerMultiView = m_multiViewShader.getUniformLocation("firstLayer");
+    m_uniformInverseViewProjections = m_multiViewShader.getUniformLocation("inverseViewProjections");
+    m_uniformCameraPositions = m_multiViewShader.getUniformLocation("cameraPositions");
+
+    // Secondary rays are shaded from the environment probe
+    std::vector<ShaderProgram const*> environmentShaders{&m_renderMeshShader, &m_renderHeightfieldShader, &m_multiViewShader};
+    for (unsigned int i = 0 ; i < m_renderFluidShader.size() ; ++i){
+        environmentShaders.push_back(&m_renderFluidShader[i]);
+    }
+    for (ShaderProgram const* shader : environmentShaders){
+        shader->useProgram();
+        glUniform1i(shader->getUniformLocation("environmentTexture"), 5);
+        glUniform1i(shader->getUniformLocation("floorEnvironmentTexture"), 7);
+    }
 
-    setUpSkybox();
-    m_uniformSkyBoxTexture = m_renderFluidShader.getUniformLocation("skyBoxTexture");
-    glUniform1i(m_uniformSkyBoxTexture, 5);
+    // Everything that shades the floor samples the transmittance volume
+    environmentShaders.push_back(&m_backgroundPlaneShader);
+    for (ShaderProgram const* shader : environmentShaders){
+        shader->useProgram();
+        glUniform1i(shader->getUniformLocation("transmittanceTexture"), 6);
+    }
 }
 
 void FluidRenderer::setUpSkybox(){
     glGenTextures(1, &m_skyBoxTexture);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_skyBoxTexture);
-    int w, h, components;
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_skyBoxTexture);
     for (unsigned int i = 0 ; i < m_skyBoxPaths.size() ; ++i){
-        //stbi_set_flip_vertically_on_load(true); 
-        unsigned char * data = stbi_load(m_skyBoxPaths[i].c_str(), &w, &h, &components, 0);
-        //stbi_set_flip_vertically_on_load(false); 
-        if (data){
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
+        ImageLoader::Image image = m_skyBoxImages[i].get();
+        if (image.compression == ImageLoader::Compression::bc1 && !Texture::supportsBC1()){
+            image = ImageLoader::decompress(image);
+        }
+        if (image.data && image.compression == ImageLoader::Compression::bc1){
+            glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, Texture::compressedRGBBC1, image.width, image.height, 0, (GLsizei)image.size, image.data.get());
+        }
+        else if (image.data){
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data.get());
         }
         else{
-            stbi_image_free(data);
             throw std::runtime_error("Failed to load cubemap texture at " + m_skyBoxPaths[i]);
         }
     }
@@ -462,6 +906,34 @@ void FluidRenderer::setUpSkybox(){
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    m_environmentProbe.valid = false;
+}
+
+// Renders the skybox, floor and spotlight into both probes, one face at a time
+void FluidRenderer::bakeEnvironment(){
+    m_bakeEnvironmentShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_skyBoxTexture);
+    GLStateCache::viewport(0, 0, EnvironmentProbe::faceSize, EnvironmentProbe::faceSize);
+    GLStateCache::disable(GL_BLEND);
+    m_quad.bindVAO();
+    for (int face = 0 ; face < 6 ; ++face){
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_environmentProbe.faceFBOs[face]);
+        glUniform1i(m_uniformFaceBake, face);
+        m_quad.draw(GL_TRIANGLES);
+    }
+    GLStateCache::enable(GL_BLEND);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    // Mipmaps keep the distant chessboard from aliasing
+    for (GLuint texture : {m_environmentProbe.environmentTexture, m_environmentProbe.floorTexture}){
+        GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    m_environmentProbe.valid = true;
 }
 
 void FluidRenderer::renderBackground() const{
@@ -472,54 +944,318 @@ void FluidRenderer::renderBackground() const{
 }
 
 void FluidRenderer::renderFluid(GLuint currentLevelSetTexture) const{
+    GLStateCache::viewport(0, 0, m_renderWidth, m_renderHeight);
+
     // Coordinates of entry/exit points of camera ray through the cube are rendered as RGB values to texture
     m_raycastingPosShader.useProgram();
     glUniformMatrix4fv(m_raycastingPosUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
     // Draw front of cube (cull back faces) in RGB to texture
-    glBindFramebuffer(GL_FRAMEBUFFER, m_frontCube.FBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_frontCube.FBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_CULL_FACE);
+    GLStateCache::enable(GL_CULL_FACE);
     glCullFace(GL_BACK);
     m_cube.bindVAO();
     m_cube.draw(GL_TRIANGLES);
 
     // Draw back of cube (cull front faces) in RGB to texture
-    glBindFramebuffer(GL_FRAMEBUFFER, m_backCube.FBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_backCube.FBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    //glEnable(GL_CULL_FACE);
+    //GLStateCache::enable(GL_CULL_FACE);
     glCullFace(GL_FRONT);
     m_cube.draw(GL_TRIANGLES);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDisable(GL_CULL_FACE); 
+    GLStateCache::disable(GL_CULL_FACE); 
     
     // Render fluid by marching using front/back RGB values as entry/exit point coordinates
-    m_renderFluidShader.useProgram();
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_2D, m_frontCube.texture.getLocation());
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, m_backCube.texture.getLocation());
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
-    glActiveTexture(GL_TEXTURE0 + 3);
-    glBindTexture(GL_TEXTURE_1D, m_splineTexture);
-    glActiveTexture(GL_TEXTURE0 + 4);
-    glBindTexture(GL_TEXTURE_1D, m_splineDerivTexture);
-    glActiveTexture(GL_TEXTURE0 + 5);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_skyBoxTexture);
+    // Blending onto a transparent target leaves the colour premultiplied by alpha, ready for compositing
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_fluidTarget.FBO);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    m_renderFluidShader[m_cellTraversal ? 1 : 0].useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_frontCube.texture.getLocation());
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_backCube.texture.getLocation());
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 3);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, m_splineTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 4);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, m_splineDerivTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 5);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.environmentTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 7);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.floorTexture);
+    m_quad.bindVAO();
+    m_quad.draw(GL_TRIANGLES);
+
+    // Tidy up texture bindings
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+}
+
+// Draws every slab of the target with the currently bound shader
+void FluidRenderer::renderVolume(VolumeTarget const& target, GLint uniformSlice) const{
+    GLStateCache::viewport(0, 0, target.size, target.size);
+    GLStateCache::disable(GL_BLEND);
+    m_quad.bindVAO();
+    if (Capabilities::slicePath() != Capabilities::SlicePath::perSlice){
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, target.layeredFBO);
+        glUniform1i(uniformSlice, 0);
+        m_quad.drawInstanced(GL_TRIANGLES, target.size);
+    }
+    else{
+        for (int zSlice = 0 ; zSlice < target.size ; ++zSlice){
+            GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, target.slabFBOs[zSlice]);
+            glUniform1f(uniformSlice, (float)zSlice);
+            m_quad.draw(GL_TRIANGLES);
+        }
+    }
+    GLStateCache::enable(GL_BLEND);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+}
+
+// Recomputes the render volumes if the level set has been republished since they were last computed
+void FluidRenderer::updateVolumes(GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture, unsigned int levelSetGeneration){
+    if (m_volumesValid && levelSetGeneration == m_volumesGeneration){
+        return;
+    }
+    upsampleLevelSet(simulationLevelSetTexture, detailCoordinatesTexture);
+    computeTransmittance();
+    m_volumesGeneration = levelSetGeneration;
+    m_volumesValid = true;
+    m_viewVolumesValid = false;
+}
+
+// Reconstructs the simulation level set at render resolution, optionally adding detail near the surface
+void FluidRenderer::upsampleLevelSet(GLuint simulationLevelSetTexture, GLuint detailCoordinatesTexture){
+    unsigned int const upsampleVariant = m_levelSetDetail ? 1 : 0;
+    m_upsampleLevelSetShader[upsampleVariant].useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, simulationLevelSetTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, detailCoordinatesTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 3);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, m_splineTexture);
+    renderVolume(m_upsampledLevelSet, m_uniformSliceUpsample[upsampleVariant]);
+
+    // Tidy up texture bindings
+    GLStateCache::bindTexture(GL_TEXTURE_1D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+}
+
+// Marches from each voxel of the low resolution volume towards the light through the upsampled level set
+void FluidRenderer::computeTransmittance(){
+    m_computeTransmittanceShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_upsampledLevelSet.texture);
+    renderVolume(m_transmittance, m_uniformSliceTransmittance);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+}
+
+// Captures the triangles of the zero level set into the mesh buffer not being drawn, one geometry shader invocation per
+// cell. Skipped while the previous capture is still in flight, as that would overwrite the mesh being drawn
+void FluidRenderer::extractSurface(GLuint currentLevelSetTexture){
+    if (!m_surfaceMesh.collect()){
+        return;
+    }
+    m_surfaceMesh.capturing = 1 - m_surfaceMesh.drawn;
+    unsigned int const current = m_surfaceMesh.capturing;
+    m_surfaceMesh.reserve(current);
+
+    m_extractSurfaceShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_surfaceMesh.triangleTableTexture);
+
+    GLStateCache::enable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_surfaceMesh.VBOs[current]);
+    glBeginQuery(GL_PRIMITIVES_GENERATED, m_surfaceMesh.generatedQueries[current]);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, m_surfaceMesh.primitivesQueries[current]);
+    glBeginTransformFeedback(GL_TRIANGLES);
+    GLStateCache::bindVertexArray(m_surfaceMesh.extractionVAO);
+    glDrawArrays(GL_POINTS, 0, SurfaceMesh::numCells);
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    GLStateCache::disable(GL_RASTERIZER_DISCARD);
+    m_surfaceMesh.pending = true;
+
+    // Tidy up texture bindings
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::bindVertexArray(0);
+}
+
+// Rasterises the last extracted mesh into the fluid target, marching only the refracted ray through the volume
+void FluidRenderer::renderSurfaceMesh(GLuint currentLevelSetTexture){
+    GLStateCache::viewport(0, 0, m_renderWidth, m_renderHeight);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_fluidTarget.FBO);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (m_surfaceMesh.numTriangles > 0){
+        m_renderMeshShader.useProgram();
+        glUniformMatrix4fv(m_renderMeshUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
+        glm::vec3 cameraPosition = m_camera.position / m_cubeScale + glm::vec3(0.5f, 0.5f, 0.5f);
+        glUniform3fv(m_uniformCameraPositionMesh, 1, glm::value_ptr(cameraPosition));
+        GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
+        GLStateCache::activeTexture(GL_TEXTURE0 + 5);
+        GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.environmentTexture);
+        GLStateCache::activeTexture(GL_TEXTURE0 + 7);
+        GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.floorTexture);
+
+        GLStateCache::enable(GL_DEPTH_TEST);
+        GLStateCache::bindVertexArray(m_surfaceMesh.VAOs[m_surfaceMesh.drawn]);
+        glDrawArrays(GL_TRIANGLES, 0, 3 * m_surfaceMesh.numTriangles);
+        GLStateCache::bindVertexArray(0);
+        GLStateCache::disable(GL_DEPTH_TEST);
+
+        // Tidy up texture bindings
+        GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+        GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+        GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    }
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+}
+
+// Reduces the level set to column heights and overhang flags, and queues an asynchronous readback of the flags
+void FluidRenderer::reduceHeightfield(GLuint currentLevelSetTexture){
+    GLStateCache::viewport(0, 0, renderGridSize, renderGridSize);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_heightfield.FBO);
+    GLStateCache::disable(GL_BLEND);
+    m_reduceHeightfieldShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
     m_quad.bindVAO();
     m_quad.draw(GL_TRIANGLES);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::enable(GL_BLEND);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+
+    // The top mip level holds the fraction of columns with overhangs
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_heightfield.texture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    pollHeightfieldOverhangs();
+    unsigned int const current = m_heightfield.current;
+    if (!m_heightfield.fences[current]){
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_heightfield.PBOs[current]);
+        glGetTexImage(GL_TEXTURE_2D, m_heightfield.topMipLevel, GL_RG, GL_FLOAT, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_heightfield.fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_heightfield.current = 1 - current;
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Consumes the oldest readback if the GPU has finished it, without waiting
+void FluidRenderer::pollHeightfieldOverhangs(){
+    unsigned int const current = m_heightfield.current;
+    GLsync& fence = m_heightfield.fences[current];
+    if (!fence){
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED){
+        return;
+    }
+    glDeleteSync(fence);
+    fence = 0;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_heightfield.PBOs[current]);
+    float const* result = static_cast<float const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 2 * sizeof(float), GL_MAP_READ_BIT));
+    if (result){
+        if (result[1] > 0.0f){
+            m_heightfield.framesWithoutOverhangs = 0;
+        }
+        else{
+            ++m_heightfield.framesWithoutOverhangs;
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+// Draws the column heights as a displaced grid into the fluid target, using the mesh shading
+void FluidRenderer::renderHeightfield(GLuint currentLevelSetTexture) const{
+    GLStateCache::viewport(0, 0, m_renderWidth, m_renderHeight);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_fluidTarget.FBO);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    m_renderHeightfieldShader.useProgram();
+    glUniformMatrix4fv(m_renderHeightfieldUniforms.m_viewTransformation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix));
+    glm::vec3 cameraPosition = m_camera.position / m_cubeScale + glm::vec3(0.5f, 0.5f, 0.5f);
+    glUniform3fv(m_uniformCameraPositionHeightfield, 1, glm::value_ptr(cameraPosition));
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_heightfield.texture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, currentLevelSetTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 5);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.environmentTexture);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 7);
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, m_environmentProbe.floorTexture);
+
+    GLStateCache::enable(GL_DEPTH_TEST);
+    GLStateCache::bindVertexArray(m_heightfield.VAO);
+    glDrawElements(GL_TRIANGLES, m_heightfield.numIndices, GL_UNSIGNED_INT, (void*)0);
+    GLStateCache::bindVertexArray(0);
+    GLStateCache::disable(GL_DEPTH_TEST);
 
     // Tidy up texture bindings
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_3D, 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::viewport(0, 0, m_screenWidth, m_screenHeight);
+}
+
+// Upscales the (premultiplied) ray marched fluid onto the screen
+void FluidRenderer::compositeFluid() const{
+    m_compositeFluidShader.useProgram();
+    GLStateCache::activeTexture(GL_TEXTURE0 + 0);
+    m_fluidTarget.texture.bind();
+    GLStateCache::blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    m_quad.bindVAO();
+    m_quad.draw(GL_TRIANGLES);
+    GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    m_fluidTarget.texture.unbind();
+}
+
+// Resizes the ray marching targets if the governor has chosen a new scale based on the timing of earlier frames
+void FluidRenderer::updateRenderResolution(){
+    if (!m_adaptiveResolution || !m_renderFluidTimer.hasResult() || !m_resolutionGovernor.update(m_renderFluidTimer.getElapsedTime())){
+        return;
+    }
+    float scale = m_resolutionGovernor.getScale();
+    m_renderWidth = std::max(1u, static_cast<unsigned int>(scale * m_screenWidth));
+    m_renderHeight = std::max(1u, static_cast<unsigned int>(scale * m_screenHeight));
+    m_frontCube.resize(m_renderWidth, m_renderHeight);
+    m_backCube.resize(m_renderWidth, m_renderHeight);
+    m_fluidTarget.resize(m_renderWidth, m_renderHeight);
+    std::cout << "Fluid render resolution: " << m_renderWidth << "x" << m_renderHeight 
+              << " (" << m_renderFluidTimer.getElapsedTime() << " ms against a budget of " << m_resolutionGovernor.getFrameBudget() << " ms)\n";
 }
 
 // Populate a 1D texture with cubic interpolation coefficients/offsets
@@ -540,12 +1276,12 @@ void FluidRenderer::setUpSplines(){
         splineData[4 * i + 3] = 1 - alpha + w3(alpha) / (w2(alpha) + w3(alpha));
     }
     glGenTextures(1, &m_splineTexture);
-    glBindTexture(GL_TEXTURE_1D, m_splineTexture);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, m_splineTexture);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, m_splineResolution, 0, GL_RGBA, GL_FLOAT, splineData.data());
-    glBindTexture(GL_TEXTURE_1D, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, 0);
 
     // For interpolating derivatives
     auto v0 = [](float a){return (-a * a + 2 * a - 1) / 2.0f;};
@@ -561,12 +1297,12 @@ void FluidRenderer::setUpSplines(){
         splineData[4 * i + 3] = 1 - alpha + v3(alpha) / (v2(alpha) + v3(alpha));
     }
     glGenTextures(1, &m_splineDerivTexture);
-    glBindTexture(GL_TEXTURE_1D, m_splineDerivTexture);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, m_splineDerivTexture);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, m_splineResolution, 0, GL_RGBA, GL_FLOAT, splineData.data());
-    glBindTexture(GL_TEXTURE_1D, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_1D, 0);
 }
 
 void FluidRenderer::Camera::updateMatrix(){
@@ -574,35 +1310,324 @@ void FluidRenderer::Camera::updateMatrix(){
     viewMatrix = glm::lookAt(position, target, up);
 }
 
-FluidRenderer::RenderTarget::RenderTarget(unsigned int width, unsigned int height) : texture{width, height} {
-    setUpBuffers();
+FluidRenderer::RenderTarget::RenderTarget(unsigned int width, unsigned int height, GLint format, bool depthBuffer) : texture{width, height, false, format} {
+    setUpBuffers(depthBuffer);
 };
 
 FluidRenderer::RenderTarget::~RenderTarget(){
     releaseBuffers();
 }
 
-void FluidRenderer::RenderTarget::setUpBuffers(){
+void FluidRenderer::RenderTarget::setUpBuffers(bool depthBuffer){
     glGenFramebuffers(1, &FBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, FBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.getLocation(), 0);
+    if (depthBuffer){
+        glGenRenderbuffers(1, &depthRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, texture.getWidth(), texture.getHeight());
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+    }
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
         throw std::runtime_error("Failed to initialise framebuffer");
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void FluidRenderer::RenderTarget::releaseBuffers(){
-    glDeleteFramebuffers(1, &FBO);
+    GLStateCache::deleteFramebuffers(1, &FBO);
+    glDeleteRenderbuffers(1, &depthRBO);
+}
+
+// The attachment refers to the texture object, so it remains valid after the texture is re-specified
+void FluidRenderer::RenderTarget::resize(unsigned int width, unsigned int height){
+    texture.resize(width, height);
+    if (depthRBO){
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+}
+
+FluidRenderer::SurfaceMesh::SurfaceMesh(){
+    glGenVertexArrays(2, VAOs);
+    glGenBuffers(2, VBOs);
+    glGenQueries(2, primitivesQueries);
+    glGenQueries(2, generatedQueries);
+    for (unsigned int i = 0 ; i < 2 ; ++i){
+        reserve(i);
+        GLStateCache::bindVertexArray(VAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, VBOs[i]);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
+    GLStateCache::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenVertexArrays(1, &extractionVAO);
+
+    glGenTextures(1, &triangleTableTexture);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, triangleTableTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, marchingCubesTableWidth, 256, 0, GL_RED_INTEGER, GL_INT, marchingCubesTriangleTable);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+FluidRenderer::SurfaceMesh::~SurfaceMesh(){
+    GLStateCache::deleteVertexArrays(2, VAOs);
+    glDeleteBuffers(2, VBOs);
+    glDeleteQueries(2, primitivesQueries);
+    glDeleteQueries(2, generatedQueries);
+    GLStateCache::deleteVertexArrays(1, &extractionVAO);
+    GLStateCache::deleteTextures(1, &triangleTableTexture);
+}
+
+FluidRenderer::VolumeTarget::VolumeTarget(int size, GLint format) : size{size}, slabFBOs(size){
+    glGenTextures(1, &texture);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, texture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_3D, 0, format, size, size, size, 0, GL_RED, GL_FLOAT, NULL);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, 0);
+
+    glGenFramebuffers(size, slabFBOs.data());
+    for (int zSlice = 0; zSlice < size; ++zSlice){
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, slabFBOs[zSlice]);
+        glFramebufferTexture3D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_3D, texture, 0, zSlice);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+            throw std::runtime_error("Failed to initialise volume framebuffer");
+        }
+    }
+    #ifndef __EMSCRIPTEN__
+    glGenFramebuffers(1, &layeredFBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, layeredFBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0);
+    #endif
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+FluidRenderer::VolumeTarget::~VolumeTarget(){
+    GLStateCache::deleteFramebuffers(1, &layeredFBO);
+    GLStateCache::deleteFramebuffers(size, slabFBOs.data());
+    GLStateCache::deleteTextures(1, &texture);
+}
+
+FluidRenderer::EnvironmentProbe::EnvironmentProbe(){
+    GLStateCache::enable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // Filter across face edges
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    environmentTexture = textures[0];
+    floorTexture = textures[1];
+    for (GLuint texture : textures){
+        GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        for (unsigned int face = 0 ; face < 6 ; ++face){
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8, faceSize, faceSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        }
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    }
+    GLStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    // Both probes are written at once
+    GLenum const drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glGenFramebuffers(6, faceFBOs);
+    for (unsigned int face = 0 ; face < 6 ; ++face){
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, faceFBOs[face]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, environmentTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, floorTexture, 0);
+        glDrawBuffers(2, drawBuffers);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+            throw std::runtime_error("Failed to initialise environment probe framebuffer");
+        }
+    }
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+FluidRenderer::EnvironmentProbe::~EnvironmentProbe(){
+    GLStateCache::deleteFramebuffers(6, faceFBOs);
+    GLStateCache::deleteTextures(1, &environmentTexture);
+    GLStateCache::deleteTextures(1, &floorTexture);
+}
+
+FluidRenderer::MultiViewTarget::MultiViewTarget(){
+    glGenFramebuffers(1, &FBO);
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(2, PBOs);
+}
+
+FluidRenderer::MultiViewTarget::~MultiViewTarget(){
+    releaseFences();
+    glDeleteBuffers(2, PBOs);
+    GLStateCache::deleteVertexArrays(1, &VAO);
+    GLStateCache::deleteFramebuffers(1, &FBO);
+    GLStateCache::deleteTextures(1, &texture);
+}
+
+// Reallocates the texture array and readback buffers if the number or size of the views has changed
+void FluidRenderer::MultiViewTarget::resize(unsigned int newWidth, unsigned int newHeight, unsigned int newLayers){
+    if (newWidth == width && newHeight == height && newLayers == layers){
+        return;
+    }
+    width = newWidth;
+    height = newHeight;
+    layers = newLayers;
+    releaseFences();
+    GLStateCache::deleteTextures(1, &texture);
+
+    glGenTextures(1, &texture);
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // Layered attachment, so the geometry shader selects the view
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        throw std::runtime_error("Failed to initialise multi-view framebuffer");
+    }
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (GLuint PBO : PBOs){
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4 * static_cast<std::size_t>(width) * height * layers, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FluidRenderer::MultiViewTarget::releaseFences(){
+    for (GLsync& fence : fences){
+        if (fence){
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+}
+
+FluidRenderer::Heightfield::Heightfield(){
+    glGenTextures(1, &texture);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, renderGridSize, renderGridSize, 0, GL_RG, GL_FLOAT, NULL);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+    topMipLevel = 0;
+    for (int size = renderGridSize ; size > 1 ; size /= 2){
+        ++topMipLevel;
+    }
+
+    glGenFramebuffers(1, &FBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        throw std::runtime_error("Failed to initialise heightfield framebuffer");
+    }
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Two triangles between each square of neighbouring columns
+    std::vector<GLuint> indices;
+    for (GLuint z = 0 ; z < renderGridSize - 1 ; ++z){
+        for (GLuint x = 0 ; x < renderGridSize - 1 ; ++x){
+            GLuint i = z * renderGridSize + x;
+            indices.insert(indices.end(), {i, i + 1, i + renderGridSize, i + 1, i + renderGridSize + 1, i + renderGridSize});
+        }
+    }
+    numIndices = indices.size();
+    glGenVertexArrays(1, &VAO);
+    GLStateCache::bindVertexArray(VAO);
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    GLStateCache::bindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    glGenBuffers(2, PBOs);
+    for (unsigned int i = 0 ; i < 2 ; ++i){
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 2 * sizeof(float), NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FluidRenderer::Heightfield::~Heightfield(){
+    for (GLsync fence : fences){
+        if (fence){
+            glDeleteSync(fence);
+        }
+    }
+    glDeleteBuffers(2, PBOs);
+    glDeleteBuffers(1, &EBO);
+    GLStateCache::deleteVertexArrays(1, &VAO);
+    GLStateCache::deleteFramebuffers(1, &FBO);
+    GLStateCache::deleteTextures(1, &texture);
+}
+
+// Makes the pending capture the mesh that is drawn once the GPU has finished it. Returns false while it is in flight
+bool FluidRenderer::SurfaceMesh::collect(){
+    if (!pending){
+        return true;
+    }
+    GLuint writtenAvailable = GL_FALSE, generatedAvailable = GL_FALSE;
+    glGetQueryObjectuiv(primitivesQueries[capturing], GL_QUERY_RESULT_AVAILABLE, &writtenAvailable);
+    glGetQueryObjectuiv(generatedQueries[capturing], GL_QUERY_RESULT_AVAILABLE, &generatedAvailable);
+    if (!writtenAvailable || !generatedAvailable){
+        return false;
+    }
+    GLuint numGenerated;
+    glGetQueryObjectuiv(primitivesQueries[capturing], GL_QUERY_RESULT, &numTriangles);
+    glGetQueryObjectuiv(generatedQueries[capturing], GL_QUERY_RESULT, &numGenerated);
+    complete = numGenerated <= numTriangles;
+    if (!complete){
+        triangleCapacity = std::min(maxTriangles, std::max(2 * triangleCapacity, numGenerated + numGenerated / 4));
+    }
+    drawn = capturing;
+    pending = false;
+    return true;
+}
+
+// Grows the given buffer to the triangle capacity, discarding its contents, if it is smaller
+void FluidRenderer::SurfaceMesh::reserve(unsigned int buffer){
+    if (bufferCapacities[buffer] >= triangleCapacity){
+        return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, VBOs[buffer]);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)triangleCapacity * 3 * floatsPerVertex * sizeof(float), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    bufferCapacities[buffer] = triangleCapacity;
+}
+
+// Forgets any earlier capture, e.g. when switching back to this mode
+void FluidRenderer::SurfaceMesh::reset(){
+    pending = false;
+    numTriangles = 0;
+    complete = false;
 }
 
 Fluid::Fluid(unsigned int w, unsigned int h) : m_simulator{}, m_renderer(w, h),
+    m_solverScheduler(m_frameBudget, m_diffusionBounds, m_pressureBounds),
     m_cameraHorizontalRotationDirection{0}, m_cameraHorizontalRotation{0.0f},
     m_cameraVerticalRotationDirection{0}, m_cameraVerticalRotation{0.0f},
-    m_applyingForce{false}
+    m_applyingForce{false}, m_levelSetDetail{false}
 {   
     try{
+        m_simulator.initialiseShaders();
         if (!m_simulator.successfullyInitialised()){
             throw std::runtime_error("Failed to create FluidController: must pass a valid simulator instance");
         }
@@ -644,6 +1669,18 @@ void Fluid::handleEvents(SDL_Event const& event){
                 case SDL_SCANCODE_R:
                     m_simulator.resetLevelSet();
                     break;
+                case SDL_SCANCODE_M:
+                    m_renderer.toggleSurfaceMode();
+                    break;
+                case SDL_SCANCODE_H:
+                    m_renderer.toggleHeightfieldFastPath();
+                    break;
+                case SDL_SCANCODE_N:
+                    toggleLevelSetDetail();
+                    break;
+                case SDL_SCANCODE_T:
+                    m_renderer.toggleCellTraversal();
+                    break;
                 default:
                     break;
             }
@@ -688,10 +1725,12 @@ void Fluid::handleEvents(SDL_Event const& event){
 }
 
 void Fluid::frame(unsigned int frameTime){
+    TRACE_SCOPE("Fluid::frame");
     updateForce();
+    updateSolverIterations();
     m_simulator.update(frameTime);
     updateCamera(frameTime);
-    m_renderer.render(m_simulator.getCurrentLevelSet());
+    m_renderer.render(m_simulator.getRenderLevelSet(), m_simulator.getDetailCoordinates(), m_simulator.getLevelSetGeneration());
 }
 
 void Fluid::updateForce(){
@@ -710,6 +1749,28 @@ void Fluid::updateForce(){
     }
 }
 
+// GPU time of each stage of the simulation and rendering, for the timing HUD
+std::vector<GPUStageTime> Fluid::getStageTimes() const{
+    std::vector<GPUStageTime> stageTimes;
+    m_simulator.getStageTimes(stageTimes);
+    m_renderer.getStageTimes(stageTimes);
+    return stageTimes;
+}
+
+// Trades solver quality against render cost to stay within the frame budget
+void Fluid::updateSolverIterations(){
+    m_solverScheduler.update(m_simulator.getSolverTimings(), m_renderer.getRenderTime());
+    m_simulator.setSolverIterations(m_solverScheduler.getDiffusionIterations(), m_solverScheduler.getPressureIterations());
+}
+
+// Procedural detail needs the simulator to advect its coordinates and the renderer to apply it
+void Fluid::toggleLevelSetDetail(){
+    m_levelSetDetail = !m_levelSetDetail;
+    m_simulator.setDetailAdvection(m_levelSetDetail);
+    m_renderer.setLevelSetDetail(m_levelSetDetail);
+    std::cout << "Level set detail: " << (m_levelSetDetail ? "enabled" : "disabled") << "\n";
+}
+
 void Fluid::updateCamera(unsigned int frameTime){
     m_cameraHorizontalRotation += frameTime * m_cameraRotationSpeed * m_cameraHorizontalRotationDirection;
     m_cameraVerticalRotation += frameTime * m_cameraRotationSpeed * m_cameraVerticalRotationDirection;
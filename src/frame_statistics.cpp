@@ -0,0 +1,77 @@
+#include "frame_statistics.hpp"
+
+FrameStatistics::FrameStatistics() : m_frameTimes{}, m_sortedFrameTimes{}, m_numFrames{0}{
+}
+
+void FrameStatistics::addFrame(unsigned int frameTime){
+    m_frameTimes[m_numFrames & (m_capacity - 1)] = frameTime;
+    ++m_numFrames;
+}
+
+// Summarises the most recent numFrames frames (or as many as are kept)
+FrameStatistics::Summary FrameStatistics::summarise(std::size_t numFrames){
+    Summary summary{};
+    numFrames = std::min({numFrames, m_numFrames, m_capacity});
+    summary.numFrames = numFrames;
+    if (numFrames == 0){
+        return summary;
+    }
+    unsigned long long totalTime = 0;
+    for (std::size_t i = 0 ; i < numFrames ; ++i){
+        unsigned int frameTime = m_frameTimes[(m_numFrames - numFrames + i) & (m_capacity - 1)];
+        m_sortedFrameTimes[i] = frameTime;
+        totalTime += frameTime;
+        std::size_t bin = std::upper_bound(histogramBinEdges.begin(), histogramBinEdges.end(), frameTime) - histogramBinEdges.begin();
+        ++summary.histogram[bin];
+    }
+    std::sort(m_sortedFrameTimes.begin(), m_sortedFrameTimes.begin() + numFrames);
+    // Nearest-rank percentiles
+    auto percentile = [&](float p){
+        std::size_t rank = static_cast<std::size_t>(std::ceil(p * numFrames));
+        return m_sortedFrameTimes[std::max(rank, std::size_t{1}) - 1] * 1e-3f;
+    };
+    summary.mean = totalTime * 1e-3f / numFrames;
+    summary.p50 = percentile(0.5f);
+    summary.p95 = percentile(0.95f);
+    summary.p99 = percentile(0.99f);
+    summary.max = m_sortedFrameTimes[numFrames - 1] * 1e-3f;
+    unsigned int const hitchTime = m_hitchFactor * m_sortedFrameTimes[(numFrames - 1) / 2];
+    summary.hitches = m_sortedFrameTimes.begin() + numFrames - std::upper_bound(m_sortedFrameTimes.begin(), m_sortedFrameTimes.begin() + numFrames, hitchTime);
+    return summary;
+}
+
+bool FrameStatistics::openCSV(std::string const& path){
+    m_csvFile.open(path);
+    if (!m_csvFile){
+        std::cerr << "[ERROR]: Failed to open frame statistics file " << path << "\n";
+        return false;
+    }
+    m_csvFile << "time_s,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches";
+    for (unsigned int edge : histogramBinEdges){
+        m_csvFile << ",under_" << edge / 1000.0f << "_ms";
+    }
+    m_csvFile << ",over_" << histogramBinEdges.back() / 1000.0f << "_ms\n";
+    return true;
+}
+
+// Appends a row if a CSV file is open
+void FrameStatistics::writeCSV(float time, Summary const& summary){
+    if (!m_csvFile.is_open()){
+        return;
+    }
+    m_csvFile << time << "," << summary.numFrames << "," << summary.mean << "," << summary.p50 << "," << summary.p95 << "," 
+              << summary.p99 << "," << summary.max << "," << summary.hitches;
+    for (unsigned int count : summary.histogram){
+        m_csvFile << "," << count;
+    }
+    m_csvFile << std::endl; // Flushed so the file is complete however the application exits
+}
+
+void FrameStatistics::log(float duration, Summary const& summary){
+    std::printf("[FRAMES]: %zu frames in %.1f s: mean %.2f, p50 %.2f, p95 %.2f, p99 %.2f, max %.2f ms, %u hitches, histogram",
+                summary.numFrames, duration, summary.mean, summary.p50, summary.p95, summary.p99, summary.max, summary.hitches);
+    for (std::size_t i = 0 ; i < numHistogramBins ; ++i){
+        std::printf("%c%u", i == 0 ? ' ' : '/', summary.histogram[i]);
+    }
+    std::printf("\n");
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "gl_call_counter.hpp"
+
+bool GLCallCounter::m_installed = false;
+std::vector<char const*> GLCallCounter::m_entryPointNames;
+std::vector<unsigned long> GLCallCounter::m_entryPointCalls, GLCallCounter::m_entryPointCallsLastFrame;
+GLCallCounter::FrameCounts GLCallCounter::m_counts{}, GLCallCounter::m_lastFrameCounts{};
+GLuint GLCallCounter::m_program = 0, GLCallCounter::m_drawFramebuffer = 0, GLCallCounter::m_readFramebuffer = 0, GLCallCounter::m_vertexArray = 0;
+unsigned int GLCallCounter::m_activeTextureUnit = 0;
+std::array<std::array<GLuint, GLCallCounter::m_numTextureTargets>, GLCallCounter::m_maxTextureUnits> GLCallCounter::m_textures{};
+
+#ifndef __EMSCRIPTEN__
+// Replaces the glad pointer with call(), which counts and observes each call before forwarding it to the driver
+template <auto& pointer, auto observer, typename Function = std::remove_reference_t<decltype(pointer)>>
+struct CountedEntryPoint;
+
+template <auto& pointer, auto observer, typename R, typename... Args>
+struct CountedEntryPoint<pointer, observer, R (APIENTRYP)(Args...)>{
+    static inline R (APIENTRYP original)(Args...) = nullptr;
+    static inline std::size_t index = 0;
+    static R APIENTRY call(Args... args){
+        ++GLCallCounter::m_entryPointCalls[index];
+        ++GLCallCounter::m_counts.calls;
+        if constexpr (std::is_invocable_v<decltype(observer), Args...>){
+            observer(args...);
+        }
+        else if constexpr (std::is_invocable_v<decltype(observer)>){
+            observer();
+        }
+        return original(args...);
+    }
+    static void install(char const* name){
+        if (!pointer || original){
+            return; // Not loaded, or already wrapped
+        }
+        index = GLCallCounter::addEntryPoint(name);
+        original = pointer;
+        pointer = &call;
+    }
+};
+
+#define FLUID_COUNT_GL_FUNCTION(name) CountedEntryPoint<glad_##name, nullptr>::install(#name)
+#define FLUID_OBSERVE_GL_FUNCTION(name, observer) CountedEntryPoint<glad_##name, &GLCallCounter::observer>::install(#name)
+#endif
+
+// Wraps every entry point used while running; shader building and capability probes are not counted. Must be called
+// after glad has loaded them
+void GLCallCounter::install(){
+    #ifndef __EMSCRIPTEN__
+    // State changes
+    FLUID_OBSERVE_GL_FUNCTION(glUseProgram, observeUseProgram);
+    FLUID_OBSERVE_GL_FUNCTION(glBindFramebuffer, observeBindFramebuffer);
+    FLUID_OBSERVE_GL_FUNCTION(glDeleteFramebuffers, observeDeleteFramebuffers);
+    FLUID_OBSERVE_GL_FUNCTION(glBindVertexArray, observeBindVertexArray);
+    FLUID_OBSERVE_GL_FUNCTION(glDeleteVertexArrays, observeDeleteVertexArrays);
+    FLUID_OBSERVE_GL_FUNCTION(glActiveTexture, observeActiveTexture);
+    FLUID_OBSERVE_GL_FUNCTION(glBindTexture, observeBindTexture);
+    FLUID_OBSERVE_GL_FUNCTION(glDeleteTextures, observeDeleteTextures);
+    FLUID_COUNT_GL_FUNCTION(glBindBuffer);
+    FLUID_COUNT_GL_FUNCTION(glBindBufferBase);
+    FLUID_COUNT_GL_FUNCTION(glBindRenderbuffer);
+    FLUID_COUNT_GL_FUNCTION(glEnable);
+    FLUID_COUNT_GL_FUNCTION(glDisable);
+    FLUID_COUNT_GL_FUNCTION(glViewport);
+    FLUID_COUNT_GL_FUNCTION(glScissor);
+    FLUID_COUNT_GL_FUNCTION(glBlendFunc);
+    FLUID_COUNT_GL_FUNCTION(glCullFace);
+    FLUID_COUNT_GL_FUNCTION(glClearColor);
+    FLUID_COUNT_GL_FUNCTION(glDrawBuffers);
+    FLUID_COUNT_GL_FUNCTION(glTexParameteri);
+    // Uniforms
+    FLUID_OBSERVE_GL_FUNCTION(glUniform1i, countUniformUpdate);
+    FLUID_OBSERVE_GL_FUNCTION(glUniform1f, countUniformUpdate);
+    FLUID_OBSERVE_GL_FUNCTION(glUniform3f, countUniformUpdate);
+    FLUID_OBSERVE_GL_FUNCTION(glUniform3fv, countUniformUpdate);
+    FLUID_OBSERVE_GL_FUNCTION(glUniformMatrix4fv, countUniformUpdate);
+    // Draws
+    FLUID_OBSERVE_GL_FUNCTION(glDrawArrays, countDraw);
+    FLUID_OBSERVE_GL_FUNCTION(glDrawArraysInstanced, countDraw);
+    FLUID_OBSERVE_GL_FUNCTION(glDrawElements, countDraw);
+    FLUID_COUNT_GL_FUNCTION(glClear);
+    FLUID_COUNT_GL_FUNCTION(glBeginTransformFeedback);
+    FLUID_COUNT_GL_FUNCTION(glEndTransformFeedback);
+    FLUID_COUNT_GL_FUNCTION(glGenerateMipmap);
+    // Uploads
+    FLUID_OBSERVE_GL_FUNCTION(glBufferData, observeBufferData);
+    FLUID_OBSERVE_GL_FUNCTION(glBufferSubData, observeBufferSubData);
+    FLUID_OBSERVE_GL_FUNCTION(glTexImage1D, observeTexImage1D);
+    FLUID_OBSERVE_GL_FUNCTION(glTexImage2D, observeTexImage2D);
+    FLUID_OBSERVE_GL_FUNCTION(glTexImage3D, observeTexImage3D);
+    FLUID_OBSERVE_GL_FUNCTION(glTexSubImage3D, observeTexSubImage3D);
+    FLUID_OBSERVE_GL_FUNCTION(glCompressedTexImage2D, observeCompressedTexImage2D);
+    FLUID_COUNT_GL_FUNCTION(glMapBufferRange);
+    FLUID_COUNT_GL_FUNCTION(glUnmapBuffer);
+    // Readback and synchronisation
+    FLUID_COUNT_GL_FUNCTION(glGetTexImage);
+    FLUID_COUNT_GL_FUNCTION(glReadPixels);
+    FLUID_COUNT_GL_FUNCTION(glFenceSync);
+    FLUID_COUNT_GL_FUNCTION(glClientWaitSync);
+    FLUID_COUNT_GL_FUNCTION(glDeleteSync);
+    FLUID_COUNT_GL_FUNCTION(glBeginQuery);
+    FLUID_COUNT_GL_FUNCTION(glEndQuery);
+    FLUID_COUNT_GL_FUNCTION(glQueryCounter);
+    FLUID_COUNT_GL_FUNCTION(glGetQueryObjectiv);
+    FLUID_COUNT_GL_FUNCTION(glGetQueryObjectuiv);
+    FLUID_COUNT_GL_FUNCTION(glGetQueryObjectui64v);
+    FLUID_COUNT_GL_FUNCTION(glGetInteger64v);
+    // Object creation
+    FLUID_COUNT_GL_FUNCTION(glGenTextures);
+    FLUID_COUNT_GL_FUNCTION(glGenBuffers);
+    FLUID_COUNT_GL_FUNCTION(glDeleteBuffers);
+    FLUID_COUNT_GL_FUNCTION(glGenVertexArrays);
+    FLUID_COUNT_GL_FUNCTION(glGenFramebuffers);
+    FLUID_COUNT_GL_FUNCTION(glFramebufferTexture);
+    FLUID_COUNT_GL_FUNCTION(glFramebufferTexture2D);
+    FLUID_COUNT_GL_FUNCTION(glFramebufferTexture3D);
+    FLUID_COUNT_GL_FUNCTION(glFramebufferTextureLayer);
+    FLUID_COUNT_GL_FUNCTION(glCheckFramebufferStatus);
+    m_entryPointCallsLastFrame.assign(m_entryPointCalls.size(), 0);
+    m_installed = true;
+    #endif
+}
+
+bool GLCallCounter::isInstalled(){
+    return m_installed;
+}
+
+// Publishes the counts accumulated since the last call
+void GLCallCounter::endFrame(){
+    if (!m_installed){
+        return;
+    }
+    m_lastFrameCounts = m_counts;
+    m_counts = FrameCounts{};
+    std::swap(m_entryPointCalls, m_entryPointCallsLastFrame);
+    std::fill(m_entryPointCalls.begin(), m_entryPointCalls.end(), 0);
+}
+
+GLCallCounter::FrameCounts const& GLCallCounter::getFrameCounts(){
+    return m_lastFrameCounts;
+}
+
+// Lists the calls made to each entry point in the last frame, most frequent first
+void GLCallCounter::dump(std::ostream& stream){
+    if (!m_installed){
+        stream << "[GL CALLS]: Not installed (build with FLUID_COUNT_GL_CALLS defined)\n";
+        return;
+    }
+    FrameCounts const& counts = m_lastFrameCounts;
+    stream << "[GL CALLS]: " << counts.calls << " calls, " << counts.draws << " draws, " << counts.uniformUpdates << " uniform updates, "
+           << counts.bytesUploaded << " bytes uploaded\n"
+           << "[GL CALLS]: binds (redundant): program " << counts.programBinds << " (" << counts.redundantProgramBinds << "), "
+           << "framebuffer " << counts.framebufferBinds << " (" << counts.redundantFramebufferBinds << "), "
+           << "vertex array " << counts.vertexArrayBinds << " (" << counts.redundantVertexArrayBinds << "), "
+           << "texture " << counts.textureBinds << " (" << counts.redundantTextureBinds << ")\n";
+    std::vector<std::pair<unsigned long, char const*>> entryPoints;
+    for (std::size_t i = 0 ; i < m_entryPointNames.size() ; ++i){
+        if (m_entryPointCallsLastFrame[i] > 0){
+            entryPoints.emplace_back(m_entryPointCallsLastFrame[i], m_entryPointNames[i]);
+        }
+    }
+    std::sort(entryPoints.rbegin(), entryPoints.rend());
+    for (auto const& [calls, name] : entryPoints){
+        stream << "    " << name << ": " << calls << "\n";
+    }
+}
+
+std::size_t GLCallCounter::addEntryPoint(char const* name){
+    m_entryPointNames.push_back(name);
+    m_entryPointCalls.push_back(0);
+    return m_entryPointNames.size() - 1;
+}
+
+void GLCallCounter::observeUseProgram(GLuint program){
+    ++m_counts.programBinds;
+    m_counts.redundantProgramBinds += program == m_program;
+    m_program = program;
+}
+
+void GLCallCounter::observeBindFramebuffer(GLenum target, GLuint framebuffer){
+    ++m_counts.framebufferBinds;
+    bool const bindDraw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool const bindRead = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    m_counts.redundantFramebufferBinds += (!bindDraw || framebuffer == m_drawFramebuffer) && (!bindRead || framebuffer == m_readFramebuffer);
+    m_drawFramebuffer = bindDraw ? framebuffer : m_drawFramebuffer;
+    m_readFramebuffer = bindRead ? framebuffer : m_readFramebuffer;
+}
+
+// Deleting a bound object reverts the binding to zero
+void GLCallCounter::observeDeleteFramebuffers(GLsizei n, GLuint const* framebuffers){
+    for (GLsizei i = 0 ; i < n ; ++i){
+        m_drawFramebuffer = framebuffers[i] == m_drawFramebuffer ? 0 : m_drawFramebuffer;
+        m_readFramebuffer = framebuffers[i] == m_readFramebuffer ? 0 : m_readFramebuffer;
+    }
+}
+
+void GLCallCounter::observeBindVertexArray(GLuint array){
+    ++m_counts.vertexArrayBinds;
+    m_counts.redundantVertexArrayBinds += array == m_vertexArray;
+    m_vertexArray = array;
+}
+
+void GLCallCounter::observeDeleteVertexArrays(GLsizei n, GLuint const* arrays){
+    for (GLsizei i = 0 ; i < n ; ++i){
+        m_vertexArray = arrays[i] == m_vertexArray ? 0 : m_vertexArray;
+    }
+}
+
+void GLCallCounter::observeActiveTexture(GLenum texture){
+    m_activeTextureUnit = std::min(static_cast<unsigned int>(texture - GL_TEXTURE0), m_maxTextureUnits - 1);
+}
+
+void GLCallCounter::observeBindTexture(GLenum target, GLuint texture){
+    ++m_counts.textureBinds;
+    unsigned int targetIndex;
+    switch (target){
+        case GL_TEXTURE_1D: targetIndex = 0; break;
+        case GL_TEXTURE_2D: targetIndex = 1; break;
+        case GL_TEXTURE_3D: targetIndex = 2; break;
+        case GL_TEXTURE_CUBE_MAP: targetIndex = 3; break;
+        case GL_TEXTURE_2D_ARRAY: targetIndex = 4; break;
+        default: return; // Not tracked
+    }
+    GLuint& boundTexture = m_textures[m_activeTextureUnit][targetIndex];
+    m_counts.redundantTextureBinds += texture == boundTexture;
+    boundTexture = texture;
+}
+
+void GLCallCounter::observeDeleteTextures(GLsizei n, GLuint const* textures){
+    for (GLsizei i = 0 ; i < n ; ++i){
+        for (auto& unit : m_textures){
+            std::replace(unit.begin(), unit.end(), textures[i], GLuint{0});
+        }
+    }
+}
+
+void GLCallCounter::observeBufferData(GLenum, GLsizeiptr size, void const* data, GLenum){
+    m_counts.bytesUploaded += data ? size : 0;
+}
+
+void GLCallCounter::observeBufferSubData(GLenum, GLintptr, GLsizeiptr size, void const*){
+    m_counts.bytesUploaded += size;
+}
+
+void GLCallCounter::observeTexImage1D(GLenum, GLint, GLint, GLsizei width, GLint, GLenum format, GLenum type, void const* pixels){
+    m_counts.bytesUploaded += pixels ? width * pixelSize(format, type) : 0;
+}
+
+void GLCallCounter::observeTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, void const* pixels){
+    m_counts.bytesUploaded += pixels ? width * height * pixelSize(format, type) : 0;
+}
+
+void GLCallCounter::observeTexImage3D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format, GLenum type, void const* pixels){
+    m_counts.bytesUploaded += pixels ? width * height * depth * pixelSize(format, type) : 0;
+}
+
+void GLCallCounter::observeTexSubImage3D(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, void const* pixels){
+    m_counts.bytesUploaded += pixels ? width * height * depth * pixelSize(format, type) : 0;
+}
+
+void GLCallCounter::observeCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei imageSize, void const* data){
+    m_counts.bytesUploaded += data ? imageSize : 0;
+}
+
+void GLCallCounter::countDraw(){
+    ++m_counts.draws;
+}
+
+void GLCallCounter::countUniformUpdate(){
+    ++m_counts.uniformUpdates;
+}
+
+// Size in bytes of one pixel of client data (unpacked, so ignoring row alignment)
+unsigned long long GLCallCounter::pixelSize(GLenum format, GLenum type){
+    unsigned long long components;
+    switch (format){
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: components = 1; break;
+        case GL_RG: case GL_RG_INTEGER: components = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: components = 3; break;
+        default: components = 4; break;
+    }
+    switch (type){
+        case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return 2 * components;
+        default: return 4 * components;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "gl_state_cache.hpp"
+
+GLStateCache::FrameStatistics GLStateCache::m_statistics{}, GLStateCache::m_lastFrameStatistics{};
+GLuint GLStateCache::m_program = m_unknown, GLStateCache::m_vertexArray = m_unknown;
+GLuint GLStateCache::m_drawFramebuffer = m_unknown, GLStateCache::m_readFramebuffer = m_unknown;
+GLuint GLStateCache::m_defaultFramebuffer = 0;
+unsigned int GLStateCache::m_activeTextureUnit = m_unknown;
+std::array<std::array<GLuint, GLStateCache::m_numTextureTargets>, GLStateCache::m_maxTextureUnits> GLStateCache::m_textures = []{
+    std::array<std::array<GLuint, m_numTextureTargets>, m_maxTextureUnits> textures;
+    for (auto& unit : textures){
+        unit.fill(m_unknown);
+    }
+    return textures;
+}();
+std::array<GLint, 4> GLStateCache::m_viewport{-1, -1, -1, -1}, GLStateCache::m_scissor{-1, -1, -1, -1};
+std::array<int, 4> GLStateCache::m_capabilities{-1, -1, -1, -1};
+std::array<GLenum, 2> GLStateCache::m_blendFunc{m_unknown, m_unknown};
+
+void GLStateCache::useProgram(GLuint program){
+    if (request(program == m_program)){
+        glUseProgram(program);
+        m_program = program;
+    }
+}
+
+void GLStateCache::bindVertexArray(GLuint array){
+    if (request(array == m_vertexArray)){
+        glBindVertexArray(array);
+        m_vertexArray = array;
+    }
+}
+
+void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer){
+    framebuffer = framebuffer == 0 ? m_defaultFramebuffer : framebuffer;
+    bool const bindDraw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool const bindRead = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if (request((!bindDraw || framebuffer == m_drawFramebuffer) && (!bindRead || framebuffer == m_readFramebuffer))){
+        glBindFramebuffer(target, framebuffer);
+        m_drawFramebuffer = bindDraw ? framebuffer : m_drawFramebuffer;
+        m_readFramebuffer = bindRead ? framebuffer : m_readFramebuffer;
+    }
+}
+
+void GLStateCache::setDefaultFramebuffer(GLuint framebuffer){
+    m_defaultFramebuffer = framebuffer;
+}
+
+void GLStateCache::activeTexture(GLenum texture){
+    unsigned int const unit = texture - GL_TEXTURE0;
+    if (request(unit == m_activeTextureUnit)){
+        glActiveTexture(texture);
+        m_activeTextureUnit = unit;
+    }
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture){
+    int targetIndex;
+    switch (target){
+        case GL_TEXTURE_1D: targetIndex = 0; break;
+        case GL_TEXTURE_2D: targetIndex = 1; break;
+        case GL_TEXTURE_3D: targetIndex = 2; break;
+        case GL_TEXTURE_CUBE_MAP: targetIndex = 3; break;
+        case GL_TEXTURE_2D_ARRAY: targetIndex = 4; break;
+        default: targetIndex = -1; break;
+    }
+    if (targetIndex < 0 || m_activeTextureUnit >= m_maxTextureUnits){
+        request(false);
+        glBindTexture(target, texture);
+        return;
+    }
+    GLuint& boundTexture = m_textures[m_activeTextureUnit][targetIndex];
+    if (request(texture == boundTexture)){
+        glBindTexture(target, texture);
+        boundTexture = texture;
+    }
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height){
+    std::array<GLint, 4> const viewport{x, y, width, height};
+    if (request(viewport == m_viewport)){
+        glViewport(x, y, width, height);
+        m_viewport = viewport;
+    }
+}
+
+void GLStateCache::scissor(GLint x, GLint y, GLsizei width, GLsizei height){
+    std::array<GLint, 4> const scissor{x, y, width, height};
+    if (request(scissor == m_scissor)){
+        glScissor(x, y, width, height);
+        m_scissor = scissor;
+    }
+}
+
+void GLStateCache::enable(GLenum capability){
+    setCapability(capability, true);
+}
+
+void GLStateCache::disable(GLenum capability){
+    setCapability(capability, false);
+}
+
+void GLStateCache::blendFunc(GLenum sourceFactor, GLenum destinationFactor){
+    std::array<GLenum, 2> const blendFunc{sourceFactor, destinationFactor};
+    if (request(blendFunc == m_blendFunc)){
+        glBlendFunc(sourceFactor, destinationFactor);
+        m_blendFunc = blendFunc;
+    }
+}
+
+// A deleted program stays in use until another is bound, so only its name is forgotten
+void GLStateCache::deleteProgram(GLuint program){
+    glDeleteProgram(program);
+    m_program = program == m_program ? m_unknown : m_program;
+}
+
+// Deleting a bound object reverts the binding to zero, and its name may then be reused
+void GLStateCache::deleteVertexArrays(GLsizei n, GLuint const* arrays){
+    glDeleteVertexArrays(n, arrays);
+    for (GLsizei i = 0 ; i < n ; ++i){
+        m_vertexArray = arrays[i] == m_vertexArray ? 0 : m_vertexArray;
+    }
+}
+
+void GLStateCache::deleteFramebuffers(GLsizei n, GLuint const* framebuffers){
+    glDeleteFramebuffers(n, framebuffers);
+    for (GLsizei i = 0 ; i < n ; ++i){
+        m_drawFramebuffer = framebuffers[i] == m_drawFramebuffer ? 0 : m_drawFramebuffer;
+        m_readFramebuffer = framebuffers[i] == m_readFramebuffer ? 0 : m_readFramebuffer;
+        m_defaultFramebuffer = framebuffers[i] == m_defaultFramebuffer ? 0 : m_defaultFramebuffer;
+    }
+}
+
+void GLStateCache::deleteTextures(GLsizei n, GLuint const* textures){
+    glDeleteTextures(n, textures);
+    for (GLsizei i = 0 ; i < n ; ++i){
+        for (auto& unit : m_textures){
+            std::replace(unit.begin(), unit.end(), textures[i], GLuint{0});
+        }
+    }
+}
+
+// Forgets all state, so that the next call of each kind is issued. Needed if GL state is changed outside this class
+void GLStateCache::invalidate(){
+    m_program = m_vertexArray = m_drawFramebuffer = m_readFramebuffer = m_unknown;
+    m_activeTextureUnit = m_unknown;
+    for (auto& unit : m_textures){
+        unit.fill(m_unknown);
+    }
+    m_viewport.fill(-1);
+    m_scissor.fill(-1);
+    m_capabilities.fill(-1);
+    m_blendFunc.fill(m_unknown);
+}
+
+// Publishes the statistics accumulated since the last call
+void GLStateCache::endFrame(){
+    m_lastFrameStatistics = m_statistics;
+    m_statistics = FrameStatistics{};
+}
+
+GLStateCache::FrameStatistics const& GLStateCache::getFrameStatistics(){
+    return m_lastFrameStatistics;
+}
+
+// Records a requested call, returning whether it must be issued
+bool GLStateCache::request(bool redundant){
+    ++m_statistics.requested;
+    m_statistics.elided += redundant;
+    return !redundant;
+}
+
+int GLStateCache::capabilityIndex(GLenum capability){
+    switch (capability){
+        case GL_BLEND: return 0;
+        case GL_SCISSOR_TEST: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_DEPTH_TEST: return 3;
+        default: return -1;
+    }
+}
+
+void GLStateCache::setCapability(GLenum capability, bool enabled){
+    int const index = capabilityIndex(capability);
+    if (index >= 0 && !request(m_capabilities[index] == enabled)){
+        return;
+    }
+    if (enabled){
+        glEnable(capability);
+    }
+    else{
+        glDisable(capability);
+    }
+    if (index >= 0){
+        m_capabilities[index] = enabled;
+    }
+}
\ No newline at end of file
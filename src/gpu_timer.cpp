@@ -0,0 +1,94 @@
+#include "gpu_timer.hpp"
+
+unsigned int GPUTimer::m_meanGeneration = 0;
+
+GPUTimer::GPUTimer(char const* traceName) : m_traceName{traceName}, m_pending{}, m_currentFrame{0}, m_hasResult{false}, m_elapsedTime{0.0f}, m_averageTime{0.0f},
+    m_generation{m_meanGeneration}, m_totalTime{0.0}, m_numResults{0}{
+    #ifndef __EMSCRIPTEN__
+    glGenQueries(2 * m_numQueryFrames, &m_queries[0][0]);
+    #endif
+}
+
+GPUTimer::~GPUTimer(){
+    #ifndef __EMSCRIPTEN__
+    glDeleteQueries(2 * m_numQueryFrames, &m_queries[0][0]);
+    #endif
+}
+
+void GPUTimer::begin(){
+    #ifndef __EMSCRIPTEN__
+    if (!Capabilities::features().timerQueries){
+        return;
+    }
+    collectResults();
+    // If the GPU is still more than a ring behind, discard the oldest query rather than wait for it
+    m_pending[m_currentFrame] = false;
+    glQueryCounter(m_queries[m_currentFrame][0], GL_TIMESTAMP);
+    #endif
+}
+
+void GPUTimer::end(){
+    #ifndef __EMSCRIPTEN__
+    if (!Capabilities::features().timerQueries){
+        return;
+    }
+    glQueryCounter(m_queries[m_currentFrame][1], GL_TIMESTAMP);
+    m_pending[m_currentFrame] = true;
+    m_currentFrame = (m_currentFrame + 1) % m_numQueryFrames;
+    #endif
+}
+
+bool GPUTimer::hasResult() const{
+    return m_hasResult;
+}
+
+float GPUTimer::getElapsedTime() const{
+    return m_elapsedTime;
+}
+
+float GPUTimer::getAverageTime() const{
+    return m_averageTime;
+}
+
+float GPUTimer::getMeanTime() const{
+    return (m_generation == m_meanGeneration && m_numResults > 0) ? m_totalTime / m_numResults : 0.0f;
+}
+
+// Results of queries issued before the reset but read back after it are included in the new mean
+void GPUTimer::resetMeans(){
+    ++m_meanGeneration;
+}
+
+// Reads back any completed queries, oldest first, keeping the most recent result
+void GPUTimer::collectResults(){
+    #ifndef __EMSCRIPTEN__
+    for (unsigned int i = 0 ; i < m_numQueryFrames ; ++i){
+        unsigned int frame = (m_currentFrame + i) % m_numQueryFrames;
+        if (!m_pending[frame]){
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[frame][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available){
+            break; // Later queries cannot have completed either
+        }
+        GLuint64 startTime, endTime;
+        glGetQueryObjectui64v(m_queries[frame][0], GL_QUERY_RESULT, &startTime);
+        glGetQueryObjectui64v(m_queries[frame][1], GL_QUERY_RESULT, &endTime);
+        m_elapsedTime = (endTime - startTime) * 1e-6f;
+        m_averageTime = m_hasResult ? m_averageTime + m_averageSmoothingFactor * (m_elapsedTime - m_averageTime) : m_elapsedTime;
+        m_hasResult = true;
+        if (m_generation != m_meanGeneration){
+            m_generation = m_meanGeneration;
+            m_totalTime = 0.0;
+            m_numResults = 0;
+        }
+        m_totalTime += m_elapsedTime;
+        ++m_numResults;
+        m_pending[frame] = false;
+        if (m_traceName){
+            Tracer::addGPUSpan(m_traceName, startTime, endTime);
+        }
+    }
+    #endif
+}
\ No newline at end of file
@@ -1,12 +1,63 @@
 #include "gui_state.hpp"
 
-GUIState::GUIState(unsigned int width, unsigned int height) : m_textRen(width, height){
+GUIState::GUIState(unsigned int width, unsigned int height) : m_textRen(width, height), m_timingTextLine{2.5f}{
 }
 
 bool GUIState::successfullyInitialised() const{
      return m_textRen.successfullyInitialised();
 }
 
+// Queues text to be drawn with the rest of the GUI at the end of the frame
+void GUIState::addText(std::string const& text, float scale, float xPos, float yPos){
+     m_textRen.addString(text, scale, xPos, yPos);
+}
+
+// Lists the GPU time of each stage, one per line, below the title
+void GUIState::addStageTimes(std::vector<GPUStageTime> const& stageTimes){
+     for (GPUStageTime const& stageTime : stageTimes){
+          char line[32];
+          std::snprintf(line, sizeof(line), "%-13s%6.2f MS", stageTime.name, stageTime.time);
+          m_textRen.addString(line, m_timingTextScale, 0.5f, m_timingTextLine);
+          m_timingTextLine += 1.25f;
+     }
+}
+
+void GUIState::addStateCacheStatistics(GLStateCache::FrameStatistics const& statistics){
+     char line[48];
+     std::snprintf(line, sizeof(line), "STATE CALLS ELIDED %lu OF %lu", statistics.elided, statistics.requested);
+     m_timingTextLine += 0.5f;
+     m_textRen.addString(line, m_timingTextScale, 0.5f, m_timingTextLine);
+     m_timingTextLine += 1.25f;
+}
+
+// Lists the GL calls of the last frame, with redundant binds in brackets
+void GUIState::addGLCallCounts(GLCallCounter::FrameCounts const& counts){
+     char lines[6][48];
+     std::snprintf(lines[0], sizeof(lines[0]), "GL CALLS %lu, DRAWS %lu", counts.calls, counts.draws);
+     std::snprintf(lines[1], sizeof(lines[1]), "PROGRAMS %lu (%lu)", counts.programBinds, counts.redundantProgramBinds);
+     std::snprintf(lines[2], sizeof(lines[2]), "FBOS %lu (%lu)", counts.framebufferBinds, counts.redundantFramebufferBinds);
+     std::snprintf(lines[3], sizeof(lines[3]), "VAOS %lu (%lu)", counts.vertexArrayBinds, counts.redundantVertexArrayBinds);
+     std::snprintf(lines[4], sizeof(lines[4]), "TEXTURES %lu (%lu)", counts.textureBinds, counts.redundantTextureBinds);
+     std::snprintf(lines[5], sizeof(lines[5]), "UNIFORMS %lu, UPLOAD %.1f KB", counts.uniformUpdates, counts.bytesUploaded / 1024.0);
+     m_timingTextLine += 0.5f;
+     for (auto const& line : lines){
+          m_textRen.addString(line, m_timingTextScale, 0.5f, m_timingTextLine);
+          m_timingTextLine += 1.25f;
+     }
+}
+
+void GUIState::toggleTimingHUD(){
+     m_timingHUDVisible = !m_timingHUDVisible;
+}
+
+bool GUIState::isTimingHUDVisible() const{
+     return m_timingHUDVisible;
+}
+
+// Text is accumulated over the frame and drawn in one batch
 void GUIState::frame(){
-     m_textRen.drawString("FLUID SIMULATION", 10.0f, 0.5f,0.5f);
+     TRACE_SCOPE("GUIState::frame");
+     m_textRen.addString("FLUID SIMULATION", 10.0f, 0.5f,0.5f);
+     m_textRen.draw();
+     m_timingTextLine = 2.5f;
 }
@@ -0,0 +1,230 @@
+#include "headless.hpp"
+
+#ifdef FLUID_HEADLESS
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height) : width{width}, height{height}{
+    try{
+        // Prefer the surfaceless platform, which needs neither a display server nor a GPU
+        char const* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")){
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay){
+                m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            }
+        }
+        if (m_display == EGL_NO_DISPLAY){
+            m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        EGLint major, minor;
+        if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor)){
+            throw std::runtime_error("Failed to initialise EGL display");
+        }
+        bool const surfaceless = hasExtension(eglQueryString(m_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+        EGLint const configAttributes[] = {
+            EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(m_display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0){
+            throw std::runtime_error("No suitable EGL config");
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)){
+            throw std::runtime_error("EGL does not support desktop OpenGL");
+        }
+        EGLint const contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (m_context == EGL_NO_CONTEXT){
+            throw std::runtime_error("Failed to create OpenGL context");
+        }
+        if (!surfaceless){
+            EGLint const pbufferAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+            m_surface = eglCreatePbufferSurface(m_display, config, pbufferAttributes);
+            if (m_surface == EGL_NO_SURFACE){
+                throw std::runtime_error("Failed to create pbuffer surface");
+            }
+        }
+        if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context)){
+            throw std::runtime_error("Failed to make OpenGL context current");
+        }
+        std::cout << "OpenGL loaded (EGL " << major << "." << minor << (surfaceless ? ", surfaceless" : ", pbuffer") << ")\n";
+
+        // Load OpenGL functions with GLAD
+        GLADloadproc const getProcAddress = (GLADloadproc)eglGetProcAddress;
+        gladLoadGLLoader(getProcAddress);
+        ShaderCache::initialise(getProcAddress);
+        bool const parallelShaderCompile = ShaderProgram::initialise(getProcAddress);
+        #ifdef FLUID_COUNT_GL_CALLS
+        GLCallCounter::install();
+        #endif
+
+        // Display device information
+        printf("Vendor:   %s\n", glGetString(GL_VENDOR));
+        printf("Renderer: %s\n", glGetString(GL_RENDERER));
+        printf("Version:  %s\n", glGetString(GL_VERSION));
+        printf("Parallel shader compile: %s\n", parallelShaderCompile ? "enabled" : "unavailable");
+        Capabilities::probe();
+        Capabilities::report();
+
+        createFramebuffer();
+        GLStateCache::viewport(0, 0, width, height);
+        GLStateCache::enable(GL_BLEND);
+        GLStateCache::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_successfullyInitialised = true;
+    }
+    catch(std::exception const& e){
+        std::cerr << "[ERROR]: " << e.what() << "\n";
+        m_successfullyInitialised = false;
+    }
+}
+
+HeadlessContext::~HeadlessContext(){
+    if (m_context != EGL_NO_CONTEXT && m_framebuffer){
+        GLStateCache::deleteFramebuffers(1, &m_framebuffer);
+        glDeleteRenderbuffers(2, m_renderbuffers);
+    }
+    if (m_display != EGL_NO_DISPLAY){
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_surface != EGL_NO_SURFACE){
+            eglDestroySurface(m_display, m_surface);
+        }
+        if (m_context != EGL_NO_CONTEXT){
+            eglDestroyContext(m_display, m_context);
+        }
+        eglTerminate(m_display);
+    }
+}
+
+bool HeadlessContext::successfullyInitialised() const{
+    return m_successfullyInitialised;
+}
+
+// Writes the offscreen framebuffer as a binary PPM
+bool HeadlessContext::writeImage(std::string const& path) const{
+    std::vector<unsigned char> pixels(3 * width * height);
+    GLStateCache::bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file){
+        std::cerr << "[ERROR]: Failed to open " << path << "\n";
+        return false;
+    }
+    std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+    for (unsigned int row = height ; row-- > 0 ;){ // GL rows are bottom to top
+        std::fwrite(pixels.data() + 3 * width * row, 1, 3 * width, file);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool HeadlessContext::hasExtension(char const* extensions, char const* name){
+    if (!extensions){
+        return false;
+    }
+    std::size_t const length = std::strlen(name);
+    for (char const* found = std::strstr(extensions, name) ; found ; found = std::strstr(found + length, name)){
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stands in for the window's framebuffer, so has the same colour and depth formats
+void HeadlessContext::createFramebuffer(){
+    glGenRenderbuffers(2, m_renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glGenFramebuffers(1, &m_framebuffer);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE){
+        throw std::runtime_error("Failed to initialise offscreen framebuffer");
+    }
+    GLStateCache::setDefaultFramebuffer(m_framebuffer);
+}
+
+HeadlessApp::HeadlessApp(Settings const& settings) : m_settings{settings}, m_context(settings.width, settings.height){
+    try{
+        if (!m_context.successfullyInitialised()){
+            throw std::runtime_error("Failed to create headless context");
+        }
+        if (m_settings.render){
+            m_fluid = std::make_unique<Fluid>(m_settings.width, m_settings.height);
+            if (!m_fluid->successfullyInitialised()){
+                throw std::runtime_error("Failed to create fluid");
+            }
+        }
+        else{
+            m_simulator = std::make_unique<FluidSimulator>();
+            m_simulator->initialiseShaders();
+            if (!m_simulator->successfullyInitialised()){
+                throw std::runtime_error("Failed to create fluid simulator");
+            }
+        }
+        ShaderCache::report();
+        m_successfullyInitialised = true;
+    }
+    catch(std::exception const& e){
+        std::cerr << "[ERROR]: " << e.what() << "\n";
+        m_successfullyInitialised = false;
+    }
+}
+
+bool HeadlessApp::successfullyInitialised() const{
+    return m_successfullyInitialised;
+}
+
+void HeadlessApp::run(){
+    GPUTimer::resetMeans();
+    auto const tStart = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0 ; i < m_settings.steps ; ++i){
+        step();
+    }
+    glFinish();
+    double const elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - tStart).count() * 1e-6;
+    std::cout << "Headless: " << m_settings.steps << " steps" << (m_settings.render ? " (rendered)" : "") << " in " << elapsed << " s, "
+              << m_settings.steps / elapsed << " steps/s\n";
+
+    std::vector<GPUStageTime> stageTimes;
+    if (m_fluid){
+        stageTimes = m_fluid->getStageTimes();
+    }
+    else{
+        m_simulator->getStageTimes(stageTimes);
+    }
+    for (GPUStageTime const& stage : stageTimes){
+        std::cout << "  " << stage.name << ": " << stage.meanTime << " ms\n";
+    }
+    if (m_fluid && !m_settings.imagePath.empty() && m_context.writeImage(m_settings.imagePath)){
+        std::cout << "Last frame written to " << m_settings.imagePath << "\n";
+    }
+}
+
+void HeadlessApp::step(){
+    TRACE_SCOPE("HeadlessApp::step");
+    Tracer::calibrateGPUClock();
+    if (m_fluid){
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        m_fluid->frame(m_settings.timeStep);
+    }
+    else{
+        m_simulator->update(m_settings.timeStep);
+    }
+    GLCallCounter::endFrame();
+    GLStateCache::endFrame();
+}
+
+#endif
\ No newline at end of file
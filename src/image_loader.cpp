@@ -0,0 +1,158 @@
+#include "image_loader.hpp"
+
+std::future<ImageLoader::Image> ImageLoader::load(std::string const& path){
+    AssetPack::Entry const* entry = AssetPack::find(path);
+    if (entry && entry->kind != AssetPack::Kind::file){
+        std::promise<Image> promise;
+        promise.set_value(fromPack(*entry));
+        return promise.get_future();
+    }
+    #ifndef __EMSCRIPTEN__
+    // std::function needs a copyable task, so the promise is shared with it
+    auto promise = std::make_shared<std::promise<Image>>();
+    pool().submit([promise, path](){
+        promise->set_value(decode(path));
+    });
+    return promise->get_future();
+    #else
+    std::promise<Image> promise;
+    promise.set_value(decode(path));
+    return promise.get_future();
+    #endif
+}
+
+std::vector<std::future<ImageLoader::Image>> ImageLoader::load(std::vector<std::string> const& paths){
+    std::vector<std::future<Image>> images;
+    for (std::string const& path : paths){
+        images.push_back(load(path));
+    }
+    return images;
+}
+
+// stbi_load only shares the (unused) flip-on-load flag between threads. An image packed as a plain file is decoded
+// from the pack
+ImageLoader::Image ImageLoader::decode(std::string const& path){
+    if (AssetPack::Entry const* entry = AssetPack::find(path)){
+        return decode(AssetPack::data(*entry), entry->size);
+    }
+    Image image;
+    image.data.reset(stbi_load(path.c_str(), &image.width, &image.height, &image.components, 0), stbi_image_free);
+    image.size = image.data ? (std::size_t)image.width * image.height * image.components : 0;
+    return image;
+}
+
+ImageLoader::Image ImageLoader::decode(unsigned char const* file, std::size_t size){
+    Image image;
+    image.data.reset(stbi_load_from_memory(file, (int)size, &image.width, &image.height, &image.components, 0), stbi_image_free);
+    image.size = image.data ? (std::size_t)image.width * image.height * image.components : 0;
+    return image;
+}
+
+// The pixels stay in the pack, which is never unmapped
+ImageLoader::Image ImageLoader::fromPack(AssetPack::Entry const& entry){
+    Image image;
+    image.width = entry.width;
+    image.height = entry.height;
+    image.components = entry.components;
+    image.compression = entry.kind == AssetPack::Kind::imageBC1 ? Compression::bc1 : Compression::none;
+    image.size = entry.size;
+    image.data = std::shared_ptr<unsigned char const>(AssetPack::data(entry), [](unsigned char const*){});
+    return image;
+}
+
+// Expands a BC1 image to RGB, for when the driver cannot sample it directly
+ImageLoader::Image ImageLoader::decompress(Image const& image){
+    if (image.compression != Compression::bc1){
+        return image;
+    }
+    Image result;
+    result.width = image.width;
+    result.height = image.height;
+    result.components = 3;
+    result.size = (std::size_t)image.width * image.height * 3;
+    unsigned char* pixels = new unsigned char[result.size];
+    result.data = std::shared_ptr<unsigned char const>(pixels, std::default_delete<unsigned char[]>());
+    unsigned char const* block = image.data.get();
+    for (int blockY = 0 ; blockY < image.height ; blockY += 4){
+        for (int blockX = 0 ; blockX < image.width ; blockX += 4, block += 8){
+            std::uint16_t const endpoints[2] = {(std::uint16_t)(block[0] | block[1] << 8), (std::uint16_t)(block[2] | block[3] << 8)};
+            int palette[4][3];
+            for (int i = 0 ; i < 2 ; ++i){
+                palette[i][0] = ((endpoints[i] >> 11) & 31) * 255 / 31;
+                palette[i][1] = ((endpoints[i] >> 5) & 63) * 255 / 63;
+                palette[i][2] = (endpoints[i] & 31) * 255 / 31;
+            }
+            for (int c = 0 ; c < 3 ; ++c){
+                if (endpoints[0] > endpoints[1]){
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                else{
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            std::uint32_t const indices = block[4] | block[5] << 8 | block[6] << 16 | (std::uint32_t)block[7] << 24;
+            for (int y = 0 ; y < 4 && blockY + y < image.height ; ++y){
+                for (int x = 0 ; x < 4 && blockX + x < image.width ; ++x){
+                    int const index = (indices >> (2 * (4 * y + x))) & 3;
+                    unsigned char* pixel = pixels + 3 * ((std::size_t)(blockY + y) * image.width + blockX + x);
+                    for (int c = 0 ; c < 3 ; ++c){
+                        pixel[c] = (unsigned char)palette[index][c];
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+#ifndef __EMSCRIPTEN__
+ImageLoader::Pool& ImageLoader::pool(){
+    static Pool pool;
+    return pool;
+}
+
+ImageLoader::Pool::Pool(){
+    unsigned int const numWorkers = std::max(1u, std::min(m_maxWorkers, std::thread::hardware_concurrency()));
+    for (unsigned int i = 0 ; i < numWorkers ; ++i){
+        m_workers.emplace_back(&Pool::work, this);
+    }
+}
+
+// Finishes any queued tasks before joining the workers
+ImageLoader::Pool::~Pool(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (std::thread& worker : m_workers){
+        worker.join();
+    }
+}
+
+void ImageLoader::Pool::submit(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+void ImageLoader::Pool::work(){
+    while (true){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this](){ return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()){
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+#endif
\ No newline at end of file
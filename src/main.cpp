@@ -8,8 +8,11 @@
 
 #include <iostream>
 #include <chrono>
+#include <string>
+#include <cstdlib>
 
 #include "app_state.hpp"
+#include "headless.hpp"
 
 #ifdef __EMSCRIPTEN__
 void mainLoopCallback(void* appState){
@@ -25,17 +28,108 @@ extern "C"
 }
 #endif
 
-int main(){
+struct CommandLineOptions{
+    bool writeTrace = false; // Write the trace ring to file on exit
+    std::string frameStatisticsPath; // CSV file for frame length statistics, if not empty
+    std::string assetPackPath = "assets.pack"; // Assets missing from the pack (or all, without one) are read from disk
+    #ifdef FLUID_HEADLESS
+    bool headless = false; // Run a fixed number of steps without a window, then exit
+    HeadlessApp::Settings headlessSettings;
+    #endif
+};
+
+// Usage: fluid [--trace [path]] [--frame-statistics path] [--shader-cache directory] [--asset-pack path]
+//              [--slice-path per-slice|geometry-layer|vertex-layer] [--disable feature]...
+// Built with FLUID_HEADLESS: [--headless steps [--no-render] [--time-step us] [--size width height] [--output path.ppm]]
+CommandLineOptions parseCommandLine(int argc, char* argv[]){
+    CommandLineOptions options;
+    for (int i = 1 ; i < argc ; ++i){
+        std::string const argument = argv[i];
+        if (argument == "--trace"){
+            options.writeTrace = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-'){
+                Tracer::setOutputPath(argv[++i]);
+            }
+        }
+        else if (argument == "--frame-statistics" && i + 1 < argc){
+            options.frameStatisticsPath = argv[++i];
+        }
+        else if (argument == "--shader-cache" && i + 1 < argc){
+            ShaderCache::setDirectory(argv[++i]);
+        }
+        else if (argument == "--asset-pack" && i + 1 < argc){
+            options.assetPackPath = argv[++i];
+        }
+        else if (argument == "--slice-path" && i + 1 < argc){
+            if (!Capabilities::forceSlicePath(argv[++i])){
+                std::cerr << "[ERROR]: Unknown slice path " << argv[i] << "\n";
+            }
+        }
+        else if (argument == "--disable" && i + 1 < argc){
+            if (!Capabilities::disable(argv[++i])){
+                std::cerr << "[ERROR]: Unknown feature " << argv[i] << "\n";
+            }
+        }
+        #ifdef FLUID_HEADLESS
+        else if (argument == "--headless" && i + 1 < argc){
+            options.headless = true;
+            options.headlessSettings.steps = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--no-render"){
+            options.headlessSettings.render = false;
+        }
+        else if (argument == "--time-step" && i + 1 < argc){
+            options.headlessSettings.timeStep = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--size" && i + 2 < argc){
+            options.headlessSettings.width = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+            options.headlessSettings.height = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--output" && i + 1 < argc){
+            options.headlessSettings.imagePath = argv[++i];
+        }
+        #endif
+        else{
+            std::cerr << "[ERROR]: Unrecognised argument " << argument << "\n";
+        }
+    }
+    return options;
+}
+
+int main(int argc, char* argv[]){
+    CommandLineOptions const options = parseCommandLine(argc, argv);
+    if (AssetPack::open(options.assetPackPath)){
+        std::cout << "Loading assets from " << options.assetPackPath << "\n";
+    }
+    #ifdef FLUID_HEADLESS
+    if (options.headless){
+        HeadlessApp headlessApp(options.headlessSettings);
+        if (!headlessApp.successfullyInitialised()){
+            return EXIT_FAILURE;
+        }
+        headlessApp.run();
+        if (options.writeTrace){
+            Tracer::write();
+        }
+        return EXIT_SUCCESS;
+    }
+    #endif
     AppState appState(640, 480, 2);
     if (!appState.successfullyInitialised()){
         return EXIT_FAILURE;
     }
+    if (!options.frameStatisticsPath.empty()){
+        appState.writeFrameStatistics(options.frameStatisticsPath);
+    }
     appState.beginLoop();
 
     #ifndef __EMSCRIPTEN__
     while (!appState.timeToQuit()){
         appState.mainLoop();
     }
+    if (options.writeTrace){
+        Tracer::write();
+    }
     #else
     emscripten_set_main_loop_arg(&mainLoopCallback, &appState, 0, 1);
     #endif
@@ -0,0 +1,66 @@
+#include "resolution_governor.hpp"
+
+ResolutionGovernor::ResolutionGovernor(float frameBudget, float minScale, float maxScale) : 
+    m_frameBudget{frameBudget}, m_minScale{minScale}, m_maxScale{maxScale}, 
+    m_scale{maxScale}, m_smoothedTime{0.0f},
+    m_framesOverBudget{0}, m_framesUnderBudget{0}
+{
+}
+
+// Feeds in the latest measured pass time (in ms). Returns true if the scale has changed.
+bool ResolutionGovernor::update(float passTime){
+    if (m_smoothedTime == 0.0f){
+        m_smoothedTime = passTime;
+    }
+    else{
+        m_smoothedTime += m_smoothingFactor * (passTime - m_smoothedTime);
+    }
+
+    float newScale = m_scale;
+    if (m_smoothedTime > m_frameBudget){
+        m_framesUnderBudget = 0;
+        if (++m_framesOverBudget >= m_framesBeforeDecrease){
+            // Jump straight to the scale predicted to meet the budget, rounding down
+            newScale = quantiseScale(m_scale * std::sqrt(m_frameBudget / m_smoothedTime));
+            if (newScale >= m_scale){
+                newScale = std::max(m_minScale, m_scale - m_scaleIncrement);
+            }
+        }
+    }
+    else{
+        m_framesOverBudget = 0;
+        float nextScale = std::min(m_maxScale, m_scale + m_scaleIncrement);
+        float predictedTime = m_smoothedTime * (nextScale * nextScale) / (m_scale * m_scale);
+        if (predictedTime < m_headroomFraction * m_frameBudget){
+            if (++m_framesUnderBudget >= m_framesBeforeIncrease){
+                newScale = nextScale;
+            }
+        }
+        else{
+            m_framesUnderBudget = 0;
+        }
+    }
+
+    if (newScale == m_scale){
+        return false;
+    }
+    // Predict the time at the new scale so stale measurements from the old scale don't trigger a further change
+    m_smoothedTime *= (newScale * newScale) / (m_scale * m_scale);
+    m_scale = newScale;
+    m_framesOverBudget = 0;
+    m_framesUnderBudget = 0;
+    return true;
+}
+
+float ResolutionGovernor::getScale() const{
+    return m_scale;
+}
+
+float ResolutionGovernor::getFrameBudget() const{
+    return m_frameBudget;
+}
+
+float ResolutionGovernor::quantiseScale(float scale) const{
+    scale = std::floor(scale / m_scaleIncrement + 1e-3f) * m_scaleIncrement;
+    return std::clamp(scale, m_minScale, m_maxScale);
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "shader_cache.hpp"
+
+ShaderCache::GetProgramBinaryFunction ShaderCache::m_getProgramBinary = nullptr;
+ShaderCache::ProgramBinaryFunction ShaderCache::m_programBinary = nullptr;
+ShaderCache::ProgramParameteriFunction ShaderCache::m_programParameteri = nullptr;
+std::string ShaderCache::m_driver;
+std::string ShaderCache::m_directory = "shader_cache";
+unsigned int ShaderCache::m_numLoaded = 0;
+unsigned int ShaderCache::m_numCompiled = 0;
+std::int64_t ShaderCache::m_buildTime = 0;
+
+#ifndef __EMSCRIPTEN__
+// Must be called with a current context, before any programs are created
+void ShaderCache::initialise(GLADloadproc getProcAddress){
+    GLint numFormats = 0;
+    glGetIntegerv(m_numProgramBinaryFormats, &numFormats);
+    glGetError(); // GL_INVALID_ENUM if program binaries are not supported at all
+    if (numFormats <= 0){
+        return;
+    }
+    m_getProgramBinary = (GetProgramBinaryFunction)getProcAddress("glGetProgramBinary");
+    m_programBinary = (ProgramBinaryFunction)getProcAddress("glProgramBinary");
+    m_programParameteri = (ProgramParameteriFunction)getProcAddress("glProgramParameteri");
+    if (!m_getProgramBinary || !m_programBinary){
+        m_getProgramBinary = nullptr;
+        m_programBinary = nullptr;
+        return;
+    }
+    m_driver = std::string((char const*)glGetString(GL_VENDOR)) + "\n" + (char const*)glGetString(GL_RENDERER) + "\n" + (char const*)glGetString(GL_VERSION);
+}
+#endif
+
+void ShaderCache::setDirectory(std::string const& directory){
+    m_directory = directory;
+}
+
+// 64-bit FNV-1a over the driver strings and the given parts, with each part's length included to separate them
+std::uint64_t ShaderCache::hash(std::vector<std::string> const& parts){
+    std::uint64_t result = 0xcbf29ce484222325;
+    auto add = [&result](std::string const& part){
+        std::string const length = std::to_string(part.size()) + ":";
+        for (char c : length + part){
+            result = (result ^ (unsigned char)c) * 0x100000001b3;
+        }
+    };
+    add(m_driver);
+    for (auto const& part : parts){
+        add(part);
+    }
+    return result;
+}
+
+// Asks the driver to keep the binary of a program about to be linked
+void ShaderCache::prepareProgram(GLuint program){
+    if (m_getProgramBinary && m_programParameteri){
+        m_programParameteri(program, m_programBinaryRetrievableHint, GL_TRUE);
+    }
+}
+
+// Links the program from a cached binary, returning false if there is no usable binary for the key
+bool ShaderCache::loadProgram(GLuint program, std::uint64_t key){
+    if (!m_programBinary){
+        return false;
+    }
+    std::ifstream file(path(key), std::ios::binary);
+    if (!file){
+        return false;
+    }
+    std::uint32_t magic = 0;
+    std::uint64_t fileKey = 0;
+    GLenum binaryFormat = 0;
+    std::uint32_t length = 0;
+    file.read((char*)&magic, sizeof(magic));
+    file.read((char*)&fileKey, sizeof(fileKey));
+    file.read((char*)&binaryFormat, sizeof(binaryFormat));
+    file.read((char*)&length, sizeof(length));
+    if (!file || magic != m_fileMagic || fileKey != key){
+        return false;
+    }
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file){
+        return false;
+    }
+    m_programBinary(program, binaryFormat, binary.data(), (GLsizei)length);
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success != GL_TRUE){
+        glGetError(); // GL_INVALID_ENUM if the binary format is no longer supported
+    }
+    return success == GL_TRUE;
+}
+
+void ShaderCache::storeProgram(GLuint program, std::uint64_t key){
+    if (!m_getProgramBinary){
+        return;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, m_programBinaryLength, &length);
+    if (length <= 0){
+        return;
+    }
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    m_getProgramBinary(program, length, NULL, &binaryFormat, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    std::ofstream file(path(key), std::ios::binary | std::ios::trunc);
+    if (error || !file){
+        std::cerr << "[ERROR]: Failed to write shader cache entry " << path(key).string() << "\n";
+        return;
+    }
+    std::uint32_t const fileLength = (std::uint32_t)length;
+    file.write((char const*)&m_fileMagic, sizeof(m_fileMagic));
+    file.write((char const*)&key, sizeof(key));
+    file.write((char const*)&binaryFormat, sizeof(binaryFormat));
+    file.write((char const*)&fileLength, sizeof(fileLength));
+    file.write(binary.data(), length);
+}
+
+void ShaderCache::addBuild(bool fromCache, std::int64_t duration){
+    ++(fromCache ? m_numLoaded : m_numCompiled);
+    m_buildTime += duration;
+}
+
+// Prints the time taken to build every program so far - a warm start is one where all came from the cache
+void ShaderCache::report(){
+    char const* start = m_numCompiled == 0 ? "warm" : (m_numLoaded == 0 ? "cold" : "partially warm");
+    std::cout << "Shader programs: " << m_numLoaded + m_numCompiled << " built in " << m_buildTime / 1000.0 << " ms ("
+              << start << " start: " << m_numLoaded << " from cache, " << m_numCompiled << " compiled";
+    if (!m_programBinary){
+        std::cout << ", cache unavailable";
+    }
+    std::cout << ")\n";
+}
+
+std::filesystem::path ShaderCache::path(std::uint64_t key){
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return std::filesystem::path(m_directory) / name;
+}
\ No newline at end of file
@@ -1,49 +1,179 @@
 #include "shader_program.hpp"
 
-// To do: move file reading out of the constructor
-ShaderProgram::ShaderProgram(const std::string vertexPath, const std::string fragmentPath){
+#ifndef __EMSCRIPTEN__
+// Lets the driver compile and link on as many threads as it likes, returning false if it has no such control
+bool ShaderProgram::initialise(GLADloadproc getProcAddress){
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    for (GLint i = 0 ; i < numExtensions ; ++i){
+        std::string const extension = (char const*)glGetStringi(GL_EXTENSIONS, i);
+        char const* function = extension == "GL_KHR_parallel_shader_compile" ? "glMaxShaderCompilerThreadsKHR"
+                             : (extension == "GL_ARB_parallel_shader_compile" ? "glMaxShaderCompilerThreadsARB" : nullptr);
+        MaxShaderCompilerThreadsFunction maxShaderCompilerThreads = function ? (MaxShaderCompilerThreadsFunction)getProcAddress(function) : nullptr;
+        if (maxShaderCompilerThreads){
+            maxShaderCompilerThreads(0xFFFFFFFF); // Implementation-defined maximum
+            return true;
+        }
+    }
+    return false;
+}
+#endif
 
-    std::string vertexSource, fragmentSource;
-    std::ifstream vertexFile, fragmentFile;
+ShaderProgram::ShaderProgram(const std::string vertexPath, const std::string fragmentPath, std::vector<std::string> const& defines){
+    buildProgram({loadStage(GL_VERTEX_SHADER, vertexPath, defines), loadStage(GL_FRAGMENT_SHADER, fragmentPath, defines)}, {});
+}
 
-    vertexFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fragmentFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try 
-    {
+ShaderProgram::ShaderProgram(const std::string vertexPath, const std::string geometryPath, const std::string fragmentPath, std::vector<std::string> const& feedbackVaryings, std::vector<std::string> const& defines){
+    std::vector<Stage> stages{loadStage(GL_VERTEX_SHADER, vertexPath, defines)};
+    if (!geometryPath.empty()){
         #ifndef __EMSCRIPTEN__
-        vertexFile.open(vertexPath.c_str());
-        fragmentFile.open(fragmentPath.c_str());
+        stages.push_back(loadStage(GL_GEOMETRY_SHADER, geometryPath, defines));
         #else
-        vertexFile.open((".//shaders_web//"+vertexPath.substr(10)).c_str());
-        fragmentFile.open((".//shaders_web//"+fragmentPath.substr(10)).c_str());
+        std::cerr << "Geometry shaders are not supported in WebGL." << std::endl;
         #endif
+    }
+    if (!fragmentPath.empty()){
+        stages.push_back(loadStage(GL_FRAGMENT_SHADER, fragmentPath, defines));
+    }
+    buildProgram(stages, feedbackVaryings);
+}
 
-        std::stringstream vertexStream, fragmentStream;
+// Links m_programID from the shader cache if possible, otherwise compiles the stages and adds the result to the cache
+void ShaderProgram::buildProgram(std::vector<Stage> const& stages, std::vector<std::string> const& feedbackVaryings){
+    auto const start = std::chrono::steady_clock::now();
+    std::vector<std::string> keyParts;
+    for (Stage const& stage : stages){
+        keyParts.push_back(std::to_string(stage.shaderType));
+        keyParts.push_back(stage.source);
+    }
+    keyParts.insert(keyParts.end(), feedbackVaryings.begin(), feedbackVaryings.end());
+    std::uint64_t const key = ShaderCache::hash(keyParts);
 
-        vertexStream << vertexFile.rdbuf();
-        fragmentStream << fragmentFile.rdbuf();		
+    m_programID = glCreateProgram();
+    bool const fromCache = ShaderCache::loadProgram(m_programID, key);
+    if (!fromCache){
+        // A rejected binary leaves the program unlinked, so start again from a fresh program
+        GLStateCache::deleteProgram(m_programID);
+        std::vector<GLuint> shaderIDs;
+        for (Stage const& stage : stages){
+            shaderIDs.push_back(compileShader(stage));
+        }
+        m_programID = glCreateProgram();
+        linkProgram(shaderIDs, feedbackVaryings);
+        m_pending = std::make_unique<PendingBuild>(PendingBuild{stages, shaderIDs, key,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()});
+        return;
+    }
+    ShaderCache::addBuild(true, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
 
-        vertexFile.close();
-        fragmentFile.close();
+// Waits for the pending compile and link, reporting any errors, and adds the program to the cache if it linked.
+// The build time counted is that spent issuing and waiting, not the time the driver spent in the background
+void ShaderProgram::finishBuild() const{
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0 ; i < m_pending->stages.size() ; ++i){
+        checkShader(m_pending->shaderIDs[i], m_pending->stages[i]);
+    }
+    if (checkProgram()){
+        ShaderCache::storeProgram(m_programID, m_pending->key);
+    }
+    for (GLuint shaderID : m_pending->shaderIDs){
+        glDeleteShader(shaderID);
+    }
+    ShaderCache::addBuild(false, m_pending->issueTime + std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    m_pending.reset();
+}
 
-        vertexSource   = vertexStream.str();
-        fragmentSource = fragmentStream.str();		
+// Reads a stage's source with its includes expanded and the defines inserted after the #version line
+ShaderProgram::Stage ShaderProgram::loadStage(GLenum shaderType, std::string const& path, std::vector<std::string> const& defines) const{
+    Stage stage{shaderType, "", {}};
+    stage.source = expandIncludes(path, stage.files);
+    if (!defines.empty()){
+        std::string injected;
+        for (std::string const& define : defines){
+            injected += "#define " + define + "\n";
+        }
+        injected += "#line 2 0\n";
+        std::size_t const versionEnd = stage.source.find('\n');
+        stage.source.insert(versionEnd == std::string::npos ? stage.source.size() : versionEnd + 1, injected);
     }
-    catch(std::ifstream::failure const& e)
-    {
-        std::cerr << "Failed to load shader from file." << std::endl;
+    return stage;
+}
+
+// Replaces each #include "file" line with the file's own (expanded) source, unless it has already been included.
+// #line directives keep compiler messages pointing at the original file and line
+std::string ShaderProgram::expandIncludes(std::string const& path, std::vector<std::string>& files) const{
+    if (std::find(files.begin(), files.end(), path) != files.end()){
+        return "";
     }
+    static std::regex const includeDirective("\\s*#\\s*include\\s+\"([^\"]+)\".*");
+    std::string const fileNumber = std::to_string(files.size());
+    files.push_back(path);
+    std::string const directory = path.substr(0, path.find_last_of('/') + 1);
 
-    GLuint vertexShaderID = compileShader((const char*)vertexSource.c_str(), GL_VERTEX_SHADER);
-    GLuint fragmentShaderID = compileShader((const char*)fragmentSource.c_str(), GL_FRAGMENT_SHADER);
+    std::istringstream stream(loadSource(path));
+    std::string source = files.size() > 1 ? "#line 1 " + fileNumber + "\n" : "";
+    std::string line;
+    std::smatch match;
+    for (int lineNumber = 1 ; std::getline(stream, line) ; ++lineNumber){
+        if (std::regex_match(line, match, includeDirective)){
+            source += expandIncludes(directory + match[1].str(), files);
+            source += "#line " + std::to_string(lineNumber + 1) + " " + fileNumber + "\n";
+        }
+        else{
+            source += line + "\n";
+        }
+    }
+    return source;
+}
 
+// Read from the asset pack if it has the file, otherwise from disk
+std::string ShaderProgram::loadSource(const std::string path) const{
+    #ifndef __EMSCRIPTEN__
+    std::string const filePath = path;
+    #else
+    std::string const filePath = ".//shaders_web//" + path.substr(10);
+    #endif
+    if (AssetPack::Entry const* entry = AssetPack::find(filePath)){
+        return std::string((char const*)AssetPack::data(*entry), entry->size);
+    }
+    std::ifstream file;
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    try 
+    {
+        file.open(filePath.c_str());
 
-    m_programID = glCreateProgram();
+        std::stringstream stream;
+        stream << file.rdbuf();
+        file.close();
+        return stream.str();
+    }
+    catch(std::ifstream::failure const& e)
+    {
+        std::cerr << "Failed to load shader from file " << path << "." << std::endl;
+    }
+    return "";
+}
 
-    glAttachShader(m_programID, vertexShaderID);
-    glAttachShader(m_programID, fragmentShaderID);
+// Links the compiled shaders into m_programID, without waiting for the result
+void ShaderProgram::linkProgram(std::vector<GLuint> const& shaderIDs, std::vector<std::string> const& feedbackVaryings){
+    for (GLuint shaderID : shaderIDs){
+        glAttachShader(m_programID, shaderID);
+    }
+    if (!feedbackVaryings.empty()){
+        // Must be specified before linking
+        std::vector<const char*> varyings;
+        for (std::string const& varying : feedbackVaryings){
+            varyings.push_back(varying.c_str());
+        }
+        glTransformFeedbackVaryings(m_programID, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+    ShaderCache::prepareProgram(m_programID);
     glLinkProgram(m_programID);
+}
 
+// Returns whether the program linked, reporting why if not
+bool ShaderProgram::checkProgram() const{
     int success, logLength;
     glGetProgramiv(m_programID, GL_LINK_STATUS, &success);
     if(!success)
@@ -53,23 +183,25 @@ ShaderProgram::ShaderProgram(const std::string vertexPath, const std::string fra
         glGetProgramInfoLog(m_programID, logLength, NULL, errorLog.data());
         std::cout << "Failed to link shader program.\n" << errorLog.data() << std::endl;
     }
-
-    glDeleteShader(vertexShaderID);
-    glDeleteShader(fragmentShaderID);
+    return success;
 }
 
-// Compiles an individual shader of the given type (e.g. GL_VERTEX_SHADER)
-GLuint ShaderProgram::compileShader(const char *source, GLenum shaderType){
-    // Compile shader from source
+// Compiles an individual shader stage, without waiting for the result
+GLuint ShaderProgram::compileShader(Stage const& stage){
+    const char* source = stage.source.c_str();
     unsigned int shaderID;
-    shaderID = glCreateShader(shaderType);
+    shaderID = glCreateShader(stage.shaderType);
     #ifndef __EMSCRIPTEN__
     glShaderSource(shaderID, 1, &source, NULL);
     #else
     glShaderSource(shaderID, 1, (const char**)&source, NULL);
     #endif
     glCompileShader(shaderID);
-    // Check for errors in compiling shader
+    return shaderID;
+}
+
+// Check for errors in compiling shader
+void ShaderProgram::checkShader(GLuint shaderID, Stage const& stage) const{
     int success, logLength;
     glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
     if(!success)
@@ -77,23 +209,69 @@ GLuint ShaderProgram::compileShader(const char *source, GLenum shaderType){
         glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
         std::vector<char> errorLog((logLength > 1)? logLength : 1);
         glGetShaderInfoLog(shaderID, logLength, NULL, errorLog.data());
-        std::cout << "Shader (" << source << ") failed to compile.\n" << errorLog.data() << std::endl;
+        std::cout << "Shader (" << stage.source << ") failed to compile.\n" << errorLog.data() << "Source strings:";
+        for (unsigned int i = 0 ; i < stage.files.size() ; ++i){
+            std::cout << " " << i << " = " << stage.files[i];
+        }
+        std::cout << std::endl;
     }
-    return shaderID;
 }
 
 ShaderProgram::~ShaderProgram(){
-    glDeleteProgram(m_programID);
+    if (m_pending){
+        for (GLuint shaderID : m_pending->shaderIDs){
+            glDeleteShader(shaderID);
+        }
+    }
+    GLStateCache::deleteProgram(m_programID);
 }
 
 GLuint ShaderProgram::getID() const{
+    if (m_pending){
+        finishBuild();
+    }
     return m_programID;
 }
 
 void ShaderProgram::useProgram() const{
-    glUseProgram(m_programID);
+    if (m_pending){
+        finishBuild();
+    }
+    GLStateCache::useProgram(m_programID);
 }
 
 GLint ShaderProgram::getUniformLocation(const std::string &name) const{
+    if (m_pending){
+        finishBuild();
+    }
     return glGetUniformLocation(m_programID, name.c_str());
+}
+
+// Connects the named uniform block, if the program uses it, to a uniform buffer binding point
+void ShaderProgram::bindUniformBlock(const std::string &name, GLuint binding) const{
+    if (m_pending){
+        finishBuild();
+    }
+    GLuint blockIndex = glGetUniformBlockIndex(m_programID, name.c_str());
+    if (blockIndex != GL_INVALID_INDEX){
+        glUniformBlockBinding(m_programID, blockIndex, binding);
+    }
+}
+
+ShaderVariants::ShaderVariants(std::string const& vertexPath, std::string const& fragmentPath, std::vector<std::string> const& features, std::vector<std::string> const& defines, std::string const& geometryPath){
+    for (unsigned int variant = 0 ; variant < (1u << features.size()) ; ++variant){
+        std::vector<std::string> variantDefines = defines;
+        for (unsigned int i = 0 ; i < features.size() ; ++i){
+            variantDefines.push_back(features[i] + ((variant >> i) & 1 ? " 1" : " 0"));
+        }
+        m_variants.push_back(std::make_unique<ShaderProgram>(vertexPath, geometryPath, fragmentPath, std::vector<std::string>{}, variantDefines));
+    }
+}
+
+unsigned int ShaderVariants::size() const{
+    return (unsigned int)m_variants.size();
+}
+
+ShaderProgram const& ShaderVariants::operator[](unsigned int variant) const{
+    return *m_variants[variant];
 }
\ No newline at end of file
@@ -0,0 +1,473 @@
+#include "slab_pass_graph.hpp"
+
+SlabPassGraph::SlabPassGraph(int gridSize) : m_gridSize{gridSize}, m_compiled{false}{
+}
+
+SlabPassGraph::~SlabPassGraph(){
+    for (auto& poolTexture : m_pool){
+        GLStateCache::deleteFramebuffers((GLsizei)poolTexture.texture.slabFBOs.size(), poolTexture.texture.slabFBOs.data());
+        GLStateCache::deleteFramebuffers(1, &poolTexture.texture.layeredFBO);
+        GLStateCache::deleteTextures(1, &poolTexture.texture.texture);
+    }
+}
+
+// Creates a persistent quantity with the given initial data, returning its index
+int SlabPassGraph::addPersistent(GLint internalFormat, std::vector<float> const& data){
+    int poolTexture = acquireTexture(internalFormat);
+    m_persistents.push_back({internalFormat, poolTexture, true});
+    uploadPersistent((int)m_persistents.size() - 1, data);
+    return (int)m_persistents.size() - 1;
+}
+
+// Vector data is given as three floats per texel, whatever the format
+void SlabPassGraph::uploadPersistent(int quantity, std::vector<float> const& data){
+    Persistent& persistent = m_persistents[quantity];
+    GLStateCache::bindTexture(GL_TEXTURE_3D, m_pool[persistent.poolTexture].texture.texture);
+    GLenum const format = pixelFormat(persistent.internalFormat);
+    if (format == GL_RGBA){
+        std::size_t const numTexels = (std::size_t)m_gridSize * m_gridSize * m_gridSize;
+        std::vector<float> padded(4 * numTexels, 0.0f);
+        for (std::size_t i = 0 ; i < numTexels ; ++i){
+            std::copy_n(data.begin() + 3 * i, 3, padded.begin() + 4 * i);
+        }
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, m_gridSize, m_gridSize, m_gridSize, format, GL_FLOAT, padded.data());
+    }
+    else{
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, m_gridSize, m_gridSize, m_gridSize, format, GL_FLOAT, data.data());
+    }
+    persistent.boundaryDefined = true;
+}
+
+GLuint SlabPassGraph::getPersistentTexture(int quantity) const{
+    return m_pool[m_persistents[quantity].poolTexture].texture.texture;
+}
+
+void SlabPassGraph::clear(){
+    m_passes.clear();
+    m_resources.clear();
+    m_schedule.clear();
+    m_compiled = false;
+}
+
+bool SlabPassGraph::isCompiled() const{
+    return m_compiled;
+}
+
+std::size_t SlabPassGraph::getPoolBytes() const{
+    std::size_t bytes = 0;
+    for (auto const& texture : m_pool){
+        bytes += bytesPerTexel(texture.internalFormat) * m_gridSize * m_gridSize * m_gridSize;
+    }
+    return bytes;
+}
+
+SlabPassGraph::Resource SlabPassGraph::importPersistent(int quantity){
+    Persistent const& persistent = m_persistents[quantity];
+    m_resources.push_back({persistent.internalFormat, quantity, -1, persistent.boundaryDefined, -1, -1, -1});
+    return (Resource)m_resources.size() - 1;
+}
+
+// Inputs are bound to texture units 0, 1, ... in order before execute is called with the output and scratch textures.
+// The output is written into the texture of the first resource in writesOver, if any, which may be one of the pass's
+// own inputs but must not be read by any later pass. The rest of writesOver and then numTemporaries textures from the
+// pool are the scratch textures, which must not be inputs
+SlabPassGraph::Resource SlabPassGraph::addPass(char const* name, GPUTimer* stage, std::vector<Input> const& inputs, GLint outputFormat, bool writesBoundary, Execute const& execute,
+                                               std::vector<Resource> const& writesOver, int numTemporaries){
+    for (unsigned int i = 0 ; i < writesOver.size() ; ++i){
+        ResourceInfo const& target = m_resources[writesOver[i]];
+        if (target.internalFormat != outputFormat){
+            throw std::runtime_error("Slab pass writes over a resource of another format\n");
+        }
+        if (target.writtenOverBy != -1 || target.exportedTo != -1 || std::count(writesOver.begin(), writesOver.end(), writesOver[i]) > 1){
+            throw std::runtime_error("Slab pass writes over a resource that is written over or exported\n");
+        }
+        for (auto const& input : inputs){
+            if (i > 0 && input.resource == writesOver[i]){
+                throw std::runtime_error("Slab pass uses one of its inputs as scratch\n");
+            }
+        }
+    }
+    m_resources.push_back({outputFormat, -1, -1, writesBoundary, -1, -1, -1});
+    m_passes.push_back({name, stage, inputs, (Resource)m_resources.size() - 1, writesBoundary, writesOver, numTemporaries, execute});
+    for (Resource target : writesOver){
+        m_resources[target].writtenOverBy = (int)m_passes.size() - 1;
+    }
+    return (Resource)m_resources.size() - 1;
+}
+
+void SlabPassGraph::exportPersistent(Resource resource, int quantity){
+    for (auto const& other : m_resources){
+        if (other.exportedTo == quantity){
+            throw std::runtime_error("Persistent quantity exported twice in one step\n");
+        }
+    }
+    if (m_resources[resource].exportedTo != -1){
+        throw std::runtime_error("Resource exported to two persistent quantities\n");
+    }
+    if (m_resources[resource].writtenOverBy != -1){
+        throw std::runtime_error("Resource exported after being written over\n");
+    }
+    m_resources[resource].exportedTo = quantity;
+}
+
+// Returns false, leaving the graph uncompiled, if a pass samples the undefined boundary of an input
+bool SlabPassGraph::compile(){
+    m_compiled = false;
+    // Cull passes that do not contribute to an export, walking back from the exports
+    std::vector<bool> needed(m_resources.size(), false);
+    for (unsigned int i = 0 ; i < m_resources.size() ; ++i){
+        needed[i] = m_resources[i].exportedTo != -1;
+    }
+    std::vector<bool> live(m_passes.size(), false);
+    for (int i = (int)m_passes.size() - 1 ; i >= 0 ; --i){
+        if (!needed[m_passes[i].output]){
+            continue;
+        }
+        live[i] = true;
+        for (auto const& input : m_passes[i].inputs){
+            needed[input.resource] = true;
+        }
+        for (Resource target : m_passes[i].writesOver){
+            needed[target] = true;
+        }
+    }
+    for (auto& resource : m_resources){
+        if (resource.writtenOverBy != -1 && !live[resource.writtenOverBy]){
+            resource.writtenOverBy = -1;
+        }
+    }
+    m_schedule.clear();
+    for (unsigned int i = 0 ; i < m_passes.size() ; ++i){
+        if (live[i]){
+            m_schedule.push_back(i);
+        }
+    }
+
+    // Sink each pass to just before its first consumer if that lowers the peak memory. Passes are considered last first
+    // so that their consumers have already settled. A moved pass is timed with the stage it lands in
+    std::size_t peak = peakMemory(m_schedule);
+    for (int i = (int)m_passes.size() - 1 ; i >= 0 ; --i){
+        if (!live[i]){
+            continue;
+        }
+        int position = (int)(std::find(m_schedule.begin(), m_schedule.end(), i) - m_schedule.begin());
+        int firstConsumer = (int)m_schedule.size();
+        for (int j = position + 1 ; j < (int)m_schedule.size() && firstConsumer == (int)m_schedule.size() ; ++j){
+            for (auto const& input : m_passes[m_schedule[j]].inputs){
+                if (input.resource == m_passes[i].output){
+                    firstConsumer = j;
+                }
+            }
+            for (Resource target : m_passes[m_schedule[j]].writesOver){
+                if (target == m_passes[i].output){
+                    firstConsumer = j;
+                }
+            }
+        }
+        if (firstConsumer == position + 1){
+            continue;
+        }
+        std::vector<int> candidate = m_schedule;
+        candidate.erase(candidate.begin() + position);
+        candidate.insert(candidate.begin() + firstConsumer - 1, i);
+        std::size_t candidatePeak = peakMemory(candidate);
+        if (candidatePeak < peak && keepsWritesOverOrder(candidate)){
+            m_passes[i].stage = m_passes[candidate[firstConsumer == (int)m_schedule.size() ? firstConsumer - 2 : firstConsumer]].stage;
+            m_schedule = candidate;
+            peak = candidatePeak;
+        }
+    }
+
+    computeLifetimes();
+    computeBoundaryDefinedness();
+
+    // Writing over an import whose persistent quantity is not replaced would change that quantity
+    bool valid = true;
+    std::vector<bool> exported(m_persistents.size(), false);
+    for (auto const& resource : m_resources){
+        if (resource.exportedTo != -1){
+            exported[resource.exportedTo] = true;
+        }
+    }
+    for (auto const& resource : m_resources){
+        if (resource.writtenOverBy != -1 && resource.importedFrom != -1 && !exported[resource.importedFrom]){
+            std::cerr << "[ERROR]: Slab pass \"" << m_passes[resource.writtenOverBy].name << "\" writes over a persistent quantity that is not exported\n";
+            valid = false;
+        }
+    }
+    // Inner passes leave the boundary of their result undefined, unless they write over a resource whose boundary is
+    // defined, as its texture may have held any other resource
+    for (int passIndex : m_schedule){
+        for (auto const& input : m_passes[passIndex].inputs){
+            if (input.sampledOnBoundary && !m_resources[input.resource].boundaryDefined){
+                std::cerr << "[ERROR]: Slab pass \"" << m_passes[passIndex].name << "\" samples the undefined boundary of an input\n";
+                valid = false;
+            }
+        }
+    }
+    m_compiled = valid;
+    return valid;
+}
+
+// Does nothing unless the graph compiled
+void SlabPassGraph::execute(){
+    if (!m_compiled){
+        return;
+    }
+    // Textures of persistent quantities are in use at the start of the step, unless replaced without being imported
+    for (auto& poolTexture : m_pool){
+        poolTexture.inUse = false;
+    }
+    std::vector<bool> imported(m_persistents.size(), false), exported(m_persistents.size(), false);
+    for (auto& resource : m_resources){
+        if (resource.importedFrom != -1){
+            imported[resource.importedFrom] = true;
+            resource.poolTexture = m_persistents[resource.importedFrom].poolTexture;
+        }
+        if (resource.exportedTo != -1){
+            exported[resource.exportedTo] = true;
+        }
+    }
+    for (unsigned int i = 0 ; i < m_persistents.size() ; ++i){
+        m_pool[m_persistents[i].poolTexture].inUse = imported[i] || !exported[i];
+    }
+    for (auto const& resource : m_resources){
+        if (resource.importedFrom != -1 && resource.lastUse == -1 && resource.exportedTo == -1 && resource.writtenOverBy == -1 && exported[resource.importedFrom]){
+            m_pool[resource.poolTexture].inUse = false;
+        }
+    }
+
+    GPUTimer* stage = nullptr;
+    for (int position = 0 ; position < (int)m_schedule.size() ; ++position){
+        Pass const& pass = m_passes[m_schedule[position]];
+        if (pass.stage != stage){
+            if (stage){
+                stage->end();
+            }
+            stage = pass.stage;
+            if (stage){
+                stage->begin();
+            }
+        }
+        ResourceInfo& output = m_resources[pass.output];
+        output.poolTexture = pass.writesOver.empty() ? acquireTexture(output.internalFormat) : m_resources[pass.writesOver[0]].poolTexture;
+        std::vector<int> scratch;
+        for (unsigned int i = 1 ; i < pass.writesOver.size() ; ++i){
+            scratch.push_back(m_resources[pass.writesOver[i]].poolTexture);
+        }
+        for (int i = 0 ; i < pass.numTemporaries ; ++i){
+            scratch.push_back(acquireTexture(output.internalFormat));
+        }
+        std::vector<Texture const*> scratchTextures;
+        for (int poolTexture : scratch){
+            scratchTextures.push_back(&m_pool[poolTexture].texture);
+        }
+        for (unsigned int i = 0 ; i < pass.inputs.size() ; ++i){
+            GLStateCache::activeTexture(GL_TEXTURE0 + i);
+            GLStateCache::bindTexture(GL_TEXTURE_3D, m_pool[m_resources[pass.inputs[i].resource].poolTexture].texture.texture);
+        }
+        pass.execute(m_pool[output.poolTexture].texture, scratchTextures);
+        for (int poolTexture : scratch){
+            m_pool[poolTexture].inUse = false;
+        }
+
+        // Release inputs after their last use, unless they are exported, written over later or hold a persistent
+        // quantity that is not
+        for (auto const& input : pass.inputs){
+            ResourceInfo const& resource = m_resources[input.resource];
+            bool held = resource.exportedTo != -1 || resource.writtenOverBy != -1 || (resource.importedFrom != -1 && !exported[resource.importedFrom]);
+            if (resource.lastUse == position && !held){
+                m_pool[resource.poolTexture].inUse = false;
+            }
+        }
+    }
+    if (stage){
+        stage->end();
+    }
+
+    for (auto const& resource : m_resources){
+        if (resource.exportedTo != -1){
+            m_persistents[resource.exportedTo].poolTexture = resource.poolTexture;
+            m_persistents[resource.exportedTo].boundaryDefined = resource.boundaryDefined;
+        }
+    }
+}
+
+std::size_t SlabPassGraph::bytesPerTexel(GLint internalFormat){
+    switch (internalFormat){
+        case GL_RGBA32F: return 16;
+        case GL_RGB32F: return 12;
+        case GL_R32F: return 4;
+        case GL_R16: return 2;
+        default: return 4;
+    }
+}
+
+// Pixel format of data uploaded to a texture of the given format
+GLenum SlabPassGraph::pixelFormat(GLint internalFormat){
+    switch (internalFormat){
+        case GL_RGBA32F: return GL_RGBA;
+        case GL_RGB32F: return GL_RGB;
+        default: return GL_RED;
+    }
+}
+
+// Texture memory needed by the pool to run the given schedule, counting the largest number of textures of each
+// format in use at once
+std::size_t SlabPassGraph::peakMemory(std::vector<int> const& schedule) const{
+    std::vector<int> lastUse(m_resources.size(), -1);
+    for (int position = 0 ; position < (int)schedule.size() ; ++position){
+        for (auto const& input : m_passes[schedule[position]].inputs){
+            lastUse[input.resource] = position;
+        }
+    }
+    std::vector<bool> exported(m_persistents.size(), false);
+    for (auto const& resource : m_resources){
+        if (resource.exportedTo != -1){
+            exported[resource.exportedTo] = true;
+        }
+    }
+    std::vector<GLint> formats;
+    std::vector<int> inUse, peak;
+    auto count = [&](GLint internalFormat, int change){
+        auto it = std::find(formats.begin(), formats.end(), internalFormat);
+        if (it == formats.end()){
+            formats.push_back(internalFormat);
+            inUse.push_back(0);
+            peak.push_back(0);
+            it = formats.end() - 1;
+        }
+        std::size_t i = it - formats.begin();
+        inUse[i] += change;
+        peak[i] = std::max(peak[i], inUse[i]);
+    };
+
+    // Imports whose persistent quantity is replaced are released after their last use, the rest are held throughout
+    std::vector<bool> imported(m_persistents.size(), false);
+    for (unsigned int i = 0 ; i < m_resources.size() ; ++i){
+        ResourceInfo const& resource = m_resources[i];
+        if (resource.importedFrom != -1){
+            imported[resource.importedFrom] = true;
+            if (!exported[resource.importedFrom] || resource.exportedTo != -1 || resource.writtenOverBy != -1 || lastUse[i] != -1){
+                count(resource.internalFormat, 1);
+            }
+        }
+    }
+    for (unsigned int i = 0 ; i < m_persistents.size() ; ++i){
+        if (!imported[i] && !exported[i]){
+            count(m_persistents[i].internalFormat, 1);
+        }
+    }
+    for (int position = 0 ; position < (int)schedule.size() ; ++position){
+        Pass const& pass = m_passes[schedule[position]];
+        if (pass.writesOver.empty()){
+            count(m_resources[pass.output].internalFormat, 1);
+        }
+        count(m_resources[pass.output].internalFormat, pass.numTemporaries);
+        count(m_resources[pass.output].internalFormat, -pass.numTemporaries - std::max(0, (int)pass.writesOver.size() - 1));
+        for (unsigned int i = 0 ; i < pass.inputs.size() ; ++i){
+            Resource input = pass.inputs[i].resource;
+            ResourceInfo const& resource = m_resources[input];
+            bool held = resource.exportedTo != -1 || resource.writtenOverBy != -1 || (resource.importedFrom != -1 && !exported[resource.importedFrom]);
+            bool repeated = std::find_if(pass.inputs.begin(), pass.inputs.begin() + i, [&](Input const& other){ return other.resource == input; }) != pass.inputs.begin() + i;
+            if (lastUse[input] == position && !held && !repeated){
+                count(resource.internalFormat, -1);
+            }
+        }
+    }
+
+    std::size_t bytes = 0;
+    for (unsigned int i = 0 ; i < formats.size() ; ++i){
+        bytes += peak[i] * bytesPerTexel(formats[i]);
+    }
+    return bytes * m_gridSize * m_gridSize * m_gridSize;
+}
+
+void SlabPassGraph::computeLifetimes(){
+    for (auto& resource : m_resources){
+        resource.lastUse = -1;
+    }
+    for (int position = 0 ; position < (int)m_schedule.size() ; ++position){
+        for (auto const& input : m_passes[m_schedule[position]].inputs){
+            m_resources[input.resource].lastUse = position;
+        }
+    }
+}
+
+// Whether every pass reading a resource that is written over still runs before the pass writing over it
+bool SlabPassGraph::keepsWritesOverOrder(std::vector<int> const& schedule) const{
+    std::vector<int> positions(m_passes.size(), -1);
+    for (int position = 0 ; position < (int)schedule.size() ; ++position){
+        positions[schedule[position]] = position;
+    }
+    for (int position = 0 ; position < (int)schedule.size() ; ++position){
+        for (auto const& input : m_passes[schedule[position]].inputs){
+            int writer = m_resources[input.resource].writtenOverBy;
+            if (writer != -1 && positions[writer] < position){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A result's boundary is defined if its pass writes the whole grid, or writes over a resource whose boundary is.
+// Imports start from their persistent quantity's current version, and lose this if the version exported in its place
+// does not have it, so that a graph that compiles is valid for every step and not just the next
+void SlabPassGraph::computeBoundaryDefinedness(){
+    for (auto& resource : m_resources){
+        if (resource.importedFrom != -1){
+            resource.boundaryDefined = m_persistents[resource.importedFrom].boundaryDefined;
+        }
+    }
+    bool changed = true;
+    while (changed){
+        for (int passIndex : m_schedule){
+            Pass const& pass = m_passes[passIndex];
+            m_resources[pass.output].boundaryDefined = pass.writesBoundary || (!pass.writesOver.empty() && m_resources[pass.writesOver[0]].boundaryDefined);
+        }
+        changed = false;
+        for (auto& resource : m_resources){
+            for (auto const& other : m_resources){
+                if (resource.importedFrom != -1 && resource.boundaryDefined && other.exportedTo == resource.importedFrom && !other.boundaryDefined){
+                    resource.boundaryDefined = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// Returns a free pool texture of the given format, creating one if there are none
+int SlabPassGraph::acquireTexture(GLint internalFormat){
+    for (unsigned int i = 0 ; i < m_pool.size() ; ++i){
+        if (!m_pool[i].inUse && m_pool[i].internalFormat == internalFormat){
+            m_pool[i].inUse = true;
+            return i;
+        }
+    }
+
+    PoolTexture poolTexture{internalFormat, {0, std::vector<GLuint>(m_gridSize, 0), 0}, true};
+    glGenTextures(1, &poolTexture.texture.texture);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, poolTexture.texture.texture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexImage3D(GL_TEXTURE_3D, 0, internalFormat, m_gridSize, m_gridSize, m_gridSize, 0, pixelFormat(internalFormat), GL_FLOAT, NULL);
+    for (int zSlice = 0; zSlice < m_gridSize; ++zSlice){
+        glGenFramebuffers(1, &poolTexture.texture.slabFBOs[zSlice]);
+        GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, poolTexture.texture.slabFBOs[zSlice]);
+        glFramebufferTexture3D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_3D, poolTexture.texture.texture, 0, zSlice);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                throw std::runtime_error("Failed to initialise framebuffer\n");
+    }
+    #ifndef __EMSCRIPTEN__
+    glGenFramebuffers(1, &poolTexture.texture.layeredFBO);
+    GLStateCache::bindFramebuffer(GL_FRAMEBUFFER, poolTexture.texture.layeredFBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, poolTexture.texture.texture, 0);
+    #endif
+    m_pool.push_back(poolTexture);
+    return (int)m_pool.size() - 1;
+}
\ No newline at end of file
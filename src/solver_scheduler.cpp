@@ -0,0 +1,105 @@
+#include "solver_scheduler.hpp"
+
+SolverScheduler::SolverScheduler(float frameBudget, SolverBounds diffusionBounds, SolverBounds pressureBounds, bool timeSlicing) :
+    m_frameBudget{frameBudget}, m_diffusionBounds{diffusionBounds}, m_pressureBounds{pressureBounds},
+    m_timeSlicing{timeSlicing},
+    m_diffusionIterations{diffusionBounds.maxIterations}, m_pressureIterations{pressureBounds.maxIterations},
+    m_pressureIterationDebt{0},
+    m_diffusionIterationCost{0.0f}, m_pressureIterationCost{0.0f}, m_fixedCost{0.0f},
+    m_framesSinceChange{0}, m_frameNumber{0}
+{
+}
+
+// Feeds in the latest GPU timings (in ms) and decides the iteration counts for the coming frame
+void SolverScheduler::update(SolverTimings const& solverTimings, float renderTime){
+    ++m_frameNumber;
+    ++m_framesSinceChange;
+    // Timings lag by a few frames, so those straddling the last change reflect the old iteration counts
+    if (!solverTimings.valid || m_framesSinceChange < m_framesBeforeChange){
+        return;
+    }
+
+    // Estimate the cost of one iteration of each solver and of everything else in the frame
+    float diffusionIterationCost = solverTimings.diffusion / std::max(1, m_diffusionIterations);
+    float pressureIterationCost = solverTimings.pressure / std::max(1, m_pressureIterations);
+    float fixedCost = std::max(0.0f, solverTimings.integration - solverTimings.diffusion - solverTimings.pressure) + renderTime;
+    if (m_fixedCost == 0.0f){
+        m_diffusionIterationCost = diffusionIterationCost;
+        m_pressureIterationCost = pressureIterationCost;
+        m_fixedCost = fixedCost;
+    }
+    else{
+        m_diffusionIterationCost += m_smoothingFactor * (diffusionIterationCost - m_diffusionIterationCost);
+        m_pressureIterationCost += m_smoothingFactor * (pressureIterationCost - m_pressureIterationCost);
+        m_fixedCost += m_smoothingFactor * (fixedCost - m_fixedCost);
+    }
+
+    // Scale both solvers by the same fraction of their quality range to fit the time available
+    float availableTime = m_headroomFraction * m_frameBudget - m_fixedCost;
+    int previousDebt = m_pressureIterationDebt;
+    int diffusionRange = m_diffusionBounds.maxIterations - m_diffusionBounds.minIterations;
+    int pressureRange = m_pressureBounds.maxIterations - m_pressureBounds.minIterations;
+    float minimumCost = m_diffusionIterationCost * m_diffusionBounds.minIterations + m_pressureIterationCost * m_pressureBounds.minIterations;
+    float rangeCost = m_diffusionIterationCost * diffusionRange + m_pressureIterationCost * pressureRange;
+    float fraction = (rangeCost > 0.0f) ? std::clamp((availableTime - minimumCost) / rangeCost, 0.0f, 1.0f) : 1.0f;
+
+    int diffusionIterations = m_diffusionBounds.minIterations + static_cast<int>(std::floor(fraction * diffusionRange));
+    int pressureIterations = m_pressureBounds.minIterations + static_cast<int>(std::floor(fraction * pressureRange));
+    char const* reason = (fraction < 1.0f) ? "over budget" : "within budget";
+
+    if (m_timeSlicing){
+        float spareTime = availableTime - (m_diffusionIterationCost * diffusionIterations + m_pressureIterationCost * pressureIterations);
+        int sparePressureIterations = (m_pressureIterationCost > 0.0f) ? static_cast<int>(std::floor(spareTime / m_pressureIterationCost)) : 0;
+        if (sparePressureIterations < 0){
+            // Even the minimum is unaffordable - defer part of the pressure solve to later frames
+            int slicedIterations = std::max(m_minSlicedPressureIterations, pressureIterations + sparePressureIterations);
+            m_pressureIterationDebt = std::min(m_maxPressureIterationDebt, m_pressureIterationDebt + pressureIterations - slicedIterations);
+            pressureIterations = slicedIterations;
+            reason = "time-slicing pressure solve";
+        }
+        else if (m_pressureIterationDebt > 0 && sparePressureIterations > 0){
+            // Repay deferred iterations using any headroom
+            int repaidIterations = std::min({m_pressureIterationDebt, sparePressureIterations, m_pressureBounds.maxIterations - pressureIterations});
+            pressureIterations += repaidIterations;
+            m_pressureIterationDebt -= repaidIterations;
+            reason = "repaying time-sliced pressure iterations";
+        }
+    }
+
+    if (diffusionIterations != m_diffusionIterations || pressureIterations != m_pressureIterations){
+        m_diffusionIterations = diffusionIterations;
+        m_pressureIterations = pressureIterations;
+        m_framesSinceChange = 0;
+        logDecision(reason, availableTime);
+    }
+    else if (m_pressureIterationDebt != previousDebt){
+        logDecision(reason, availableTime);
+    }
+}
+
+int SolverScheduler::getDiffusionIterations() const{
+    return m_diffusionIterations;
+}
+
+int SolverScheduler::getPressureIterations() const{
+    return m_pressureIterations;
+}
+
+void SolverScheduler::setTimeSlicing(bool timeSlicing){
+    m_timeSlicing = timeSlicing;
+    if (!m_timeSlicing){
+        m_pressureIterationDebt = 0;
+    }
+}
+
+// Only built with FLUID_LOG_SCHEDULER defined, as decisions can change every few frames under load
+void SolverScheduler::logDecision([[maybe_unused]] char const* reason, [[maybe_unused]] float availableTime) const{
+    #ifdef FLUID_LOG_SCHEDULER
+    std::cout << "[SCHEDULER]: frame " << m_frameNumber << " (" << reason << "): "
+              << "diffusion " << m_diffusionIterations << " [" << m_diffusionBounds.minIterations << "-" << m_diffusionBounds.maxIterations << "], "
+              << "pressure " << m_pressureIterations << " [" << m_pressureBounds.minIterations << "-" << m_pressureBounds.maxIterations << "], "
+              << "deferred " << m_pressureIterationDebt << ", "
+              << "per-iteration " << m_diffusionIterationCost << "/" << m_pressureIterationCost << " ms, "
+              << "fixed " << m_fixedCost << " ms, available " << availableTime << " of " << m_frameBudget << " ms\n";
+    #endif
+}
\ No newline at end of file
@@ -2,15 +2,11 @@
 
 TextRenderer::TextRenderer(unsigned int w, unsigned int h) : 
     m_shader(".//shaders//text.vert", ".//shaders//text.frag"),
-    m_texture{".//res//lucida_typewriter_font_v2.tga"}
+    m_texture{m_fontImage.get(), m_fontPath}
 {   
     try{
         setUpBuffers();
         m_shader.useProgram();
-        m_uniformModelTrans = m_shader.getUniformLocation("model");
-        if (m_uniformModelTrans < 0)
-            throw std::runtime_error("Failed to get get location of uniform \'model\'");
-
         m_uniformProjTrans = m_shader.getUniformLocation("projection");
         if (m_uniformProjTrans < 0)
             throw std::runtime_error("Failed to get get location of uniform \'projection\'");
@@ -18,12 +14,6 @@ TextRenderer::TextRenderer(unsigned int w, unsigned int h) :
         // Set orthogonal projection matrix
         glm::mat4 projection = glm::ortho(0.0f, (float)w,  (float)h, 0.0f, -1.0f, 1.0f);
         glUniformMatrix4fv(m_uniformProjTrans, 1, GL_FALSE, glm::value_ptr(projection));
-
-        setPosition(100.0f, 320.0f, 240.0f);
-
-        m_uniformTextureCoordOffset = m_shader.getUniformLocation("textureCoordOffset");
-        if (m_uniformTextureCoordOffset < 0)
-            throw std::runtime_error("Failed to get get location of uniform \'textureCoordOffset\'");
         m_successfullyInitialised = true;
     }
     catch (std::exception const& e){
@@ -41,68 +31,94 @@ void TextRenderer::setUpBuffers(){
     glGenBuffers(1, &m_VBO);
     glGenBuffers(1, &m_EBO);
 
-    glBindVertexArray(m_VAO); 
-
-    // Copy vertex data into VBO
+    GLStateCache::bindVertexArray(m_VAO); 
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_quadVertexData.size()*sizeof(float), m_quadVertexData.data(), GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2*sizeof(float)));
-
-    // Copy element data into EBO
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_quadElementData.size()*sizeof(GLuint), m_quadElementData.data(), GL_STATIC_DRAW);
+    GLStateCache::bindVertexArray(0);
 
-    glBindVertexArray(0);
+    reserveGlyphs(256);
 }
 
 void TextRenderer::releaseBuffers(){
-    glDeleteVertexArrays(1, &m_VAO);
+    GLStateCache::deleteVertexArrays(1, &m_VAO);
     glDeleteBuffers(1, &m_VBO);
     glDeleteBuffers(1, &m_EBO);
 }
 
+// Grows the streaming vertex buffer and the (static) element buffer to hold at least glyphCount quads
+void TextRenderer::reserveGlyphs(std::size_t glyphCount){
+    if (glyphCount <= m_glyphCapacity){
+        return;
+    }
+    m_glyphCapacity = std::max(glyphCount, 2 * m_glyphCapacity);
+    std::vector<GLuint> elementData;
+    elementData.reserve(m_glyphCapacity * m_quadElementData.size());
+    for (GLuint glyph = 0 ; glyph < m_glyphCapacity ; ++glyph){
+        for (GLuint element : m_quadElementData){
+            elementData.push_back(4 * glyph + element);
+        }
+    }
+    GLStateCache::bindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_glyphCapacity * m_quadVertexData.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, elementData.size() * sizeof(GLuint), elementData.data(), GL_STATIC_DRAW);
+    GLStateCache::bindVertexArray(0);
+}
+
 // Limited to uppercase letters, numbers and common symbols
-void TextRenderer::setChar(char toDraw) const{
+glm::vec2 TextRenderer::getCharOffset(char toDraw) const{
     toDraw = toupper(toDraw);
     if (toDraw < ' ' || toDraw > '_'){
-        glUniform2f(m_uniformTextureCoordOffset, 0.0f, 0.0f); // Draw space if out of range
-    }
-    else{
-        int xOffset = (toDraw - ' ') % 8;
-        int yOffset = (toDraw - ' ') / 8;
-        glUniform2f(m_uniformTextureCoordOffset, xOffset*0.125f, yOffset*0.125f);
+        return glm::vec2(0.0f, 0.0f); // Draw space if out of range
     }
+    int xOffset = (toDraw - ' ') % 8;
+    int yOffset = (toDraw - ' ') / 8;
+    return glm::vec2(xOffset*0.125f, yOffset*0.125f);
 }
 
 bool TextRenderer::successfullyInitialised() const{
     return m_successfullyInitialised;
 }
 
-void TextRenderer::setPosition(float scale, float xPos, float yPos) const{
-    glm::mat4 trans = glm::mat4(1.0f);
-    trans = glm::scale(trans, glm::vec3(scale, scale, 1)); 
-    trans = glm::translate(trans, glm::vec3(xPos, yPos, 0.0f));
-    glUniformMatrix4fv(m_uniformModelTrans, 1, GL_FALSE, glm::value_ptr(trans));
+// Queues a quad per character. Positions are in units of the (square) character size
+void TextRenderer::addString(std::string const& toDraw, float scale, float xPos, float yPos){
+    for (auto& ch : toDraw){
+        glm::vec2 offset = getCharOffset(ch);
+        for (std::size_t i = 0 ; i < m_quadVertexData.size() ; i += 4){
+            m_glyphVertexData.push_back(scale * (xPos + m_quadVertexData[i]));
+            m_glyphVertexData.push_back(scale * (yPos + m_quadVertexData[i + 1]));
+            m_glyphVertexData.push_back(m_quadVertexData[i + 2] + offset.x);
+            m_glyphVertexData.push_back(m_quadVertexData[i + 3] + offset.y);
+        }
+        xPos += 1;
+    }
+}
+
+void TextRenderer::addStringCentred(std::string const& toDraw, float scale, float xPos, float yPos){
+    addString(toDraw, scale, xPos-0.5f*toDraw.length()*scale, yPos);
 }
 
-void TextRenderer::drawString(std::string const& toDraw, float scale, float xPos, float yPos) const{
+// Draws every queued string with one call. The buffer is orphaned first, so the upload does not wait on the last draw
+void TextRenderer::draw(){
+    std::size_t const glyphCount = m_glyphVertexData.size() / m_quadVertexData.size();
+    if (glyphCount == 0){
+        return;
+    }
+    reserveGlyphs(glyphCount);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, m_glyphCapacity * m_quadVertexData.size() * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_glyphVertexData.size() * sizeof(float), m_glyphVertexData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     m_texture.bind();
     m_shader.useProgram();
-    glBindVertexArray(m_VAO);
-    setPosition(scale, xPos, yPos);
-    for (auto& ch : toDraw){
-        setChar(ch);
-        glDrawElements(GL_TRIANGLE_STRIP, m_quadElementData.size(), GL_UNSIGNED_INT, 0);
-        xPos += 1;;
-        setPosition(scale, xPos, yPos);
-    }
-    glBindVertexArray(0);
+    GLStateCache::bindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, glyphCount * m_quadElementData.size(), GL_UNSIGNED_INT, 0);
+    GLStateCache::bindVertexArray(0);
     m_texture.unbind();
-}
-
-void TextRenderer::drawStringCentred(std::string const& toDraw, float scale, float xPos, float yPos) const{
-    drawString(toDraw, scale, xPos-0.5f*toDraw.length()*scale, yPos);
+    m_glyphVertexData.clear();
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "texture.hpp"
 
-Texture::Texture(unsigned int w, unsigned int h, bool useNearest) : m_width(w), m_height(h){
+Texture::Texture(unsigned int w, unsigned int h, bool useNearest, GLint format) : m_width(w), m_height(h), m_format{format}{
     glGenTextures(1, &m_texture);
     bind();
     if (!useNearest){
@@ -12,11 +12,13 @@ Texture::Texture(unsigned int w, unsigned int h, bool useNearest) : m_width(w),
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     }
     
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_format, m_width, m_height, 0, m_format, GL_UNSIGNED_BYTE, NULL);
     unbind();
 }
 
-Texture::Texture(const std::string& path){
+Texture::Texture(const std::string& path) : Texture(ImageLoader::load(path).get(), path){}
+
+Texture::Texture(ImageLoader::Image const& image, std::string const& path) : m_width{image.width}, m_height{image.height}, m_numberOfChannels{image.components}{
     glGenTextures(1, &m_texture);
     bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	
@@ -24,41 +26,62 @@ Texture::Texture(const std::string& path){
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    // stbi_set_flip_vertically_on_load(true); 
-    unsigned char *data = stbi_load(path.c_str(), &m_width, &m_height, &m_numberOfChannels, 0);
-    if (data)
+    if (image.data)
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data.get());
         glGenerateMipmap(GL_TEXTURE_2D);
     }
     else
     {
         std::cout << "Failed to load texture " << path << "\n";
     }
-    stbi_image_free(data);
     unbind();
 }
 
 Texture::~Texture(){
-    glDeleteTextures(1, &m_texture);
+    GLStateCache::deleteTextures(1, &m_texture);
 }
 
 void Texture::bind() const{
-    glBindTexture(GL_TEXTURE_2D, m_texture);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, m_texture);
 }
 
 void Texture::unbind() const{
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 GLuint Texture::getLocation() const{
     return m_texture;
 }
 
+GLint Texture::getWidth() const{
+    return m_width;
+}
+
+GLint Texture::getHeight() const{
+    return m_height;
+}
+
 void Texture::resize(unsigned int width, unsigned int height){
     bind();
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_format, width, height, 0, m_format, GL_UNSIGNED_BYTE, NULL);
     m_width = width;
     m_height = height;
     unbind();
+}
+
+// If BC1 (S3TC DXT1) images can be uploaded as they are - not core in GL 3.3, but offered by all desktop drivers
+bool Texture::supportsBC1(){
+    static bool const supported = [](){
+        GLint numExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+        for (GLint i = 0 ; i < numExtensions ; ++i){
+            std::string const extension = (char const*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension == "GL_EXT_texture_compression_s3tc" || extension == "GL_EXT_texture_compression_dxt1"){
+                return true;
+            }
+        }
+        return false;
+    }();
+    return supported;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "trace.hpp"
+
+std::vector<Tracer::Event> Tracer::m_events(m_capacity);
+std::atomic<std::size_t> Tracer::m_nextEvent{0};
+std::int64_t Tracer::m_gpuClockOffset = 0;
+std::int64_t Tracer::m_lastCalibration = 0;
+bool Tracer::m_gpuClockCalibrated = false;
+std::string Tracer::m_outputPath = "trace.json";
+
+std::int64_t Tracer::now(){
+    static auto const epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Tracer::addCPUSpan(char const* name, std::int64_t start, std::int64_t end){
+    m_events[m_nextEvent.fetch_add(1, std::memory_order_relaxed) & (m_capacity - 1)] = Event{name, start, end - start, false};
+}
+
+void Tracer::addGPUSpan(char const* name, std::uint64_t gpuStart, std::uint64_t gpuEnd){
+    #ifndef __EMSCRIPTEN__
+    if (!m_gpuClockCalibrated){
+        calibrateGPUClock();
+    }
+    std::int64_t start = (static_cast<std::int64_t>(gpuStart) + m_gpuClockOffset) / 1000;
+    std::int64_t duration = static_cast<std::int64_t>(gpuEnd - gpuStart) / 1000;
+    m_events[m_nextEvent.fetch_add(1, std::memory_order_relaxed) & (m_capacity - 1)] = Event{name, start, duration, true};
+    #endif
+}
+
+// Reads the GPU and CPU clocks back to back. Only done once per interval, as the read may flush the command stream
+void Tracer::calibrateGPUClock(){
+    #ifndef __EMSCRIPTEN__
+    std::int64_t const cpuTime = now();
+    if (m_gpuClockCalibrated && cpuTime - m_lastCalibration < m_calibrationInterval){
+        return;
+    }
+    GLint64 gpuTime = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+    m_gpuClockOffset = (cpuTime + now()) * 500 - gpuTime; // Midpoint of the CPU reads, in ns
+    m_lastCalibration = cpuTime;
+    m_gpuClockCalibrated = true;
+    #endif
+}
+
+void Tracer::setOutputPath(std::string const& path){
+    m_outputPath = path;
+}
+
+// Writes the events in the ring, oldest first, as Chrome trace-event JSON. CPU and GPU spans appear as two threads
+bool Tracer::write(){
+    try{
+        std::ofstream file(m_outputPath);
+        if (!file){
+            throw std::runtime_error("Failed to open trace file " + m_outputPath);
+        }
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+        std::size_t const lastEvent = m_nextEvent.load(std::memory_order_relaxed);
+        std::size_t const firstEvent = lastEvent > m_capacity ? lastEvent - m_capacity : 0;
+        for (std::size_t i = firstEvent ; i < lastEvent ; ++i){
+            Event const& event = m_events[i & (m_capacity - 1)];
+            file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << (event.gpu ? "gpu" : "cpu")
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+                 << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << "}";
+        }
+        file << "\n]}\n";
+        if (!file){
+            throw std::runtime_error("Failed to write trace file " + m_outputPath);
+        }
+        std::cout << "Trace of " << lastEvent - firstEvent << " events written to " << m_outputPath << "\n";
+        return true;
+    }
+    catch (std::exception const& e){
+        std::cerr << "[ERROR]: " << e.what() << "\n";
+        return false;
+    }
+}
+
+TraceScope::TraceScope(char const* name) : m_name{name}, m_start{Tracer::now()}{
+}
+
+TraceScope::~TraceScope(){
+    Tracer::addCPUSpan(m_name, m_start, Tracer::now());
+}
\ No newline at end of file
@@ -67,15 +67,33 @@ void Window::toggleFullScreen(){
 }
 
 void Window::frame(unsigned int frameTime){
-    // Calculate average frame length and FPS for display in title bar
-    m_timeSinceLastUpdate += frameTime;
-    ++m_numberOfFramesSinceLastUpdate;
-    if (m_timeSinceLastUpdate > 1000000){ // every second
-        float avgFrameTime = (float)m_timeSinceLastUpdate / ((float)m_numberOfFramesSinceLastUpdate*1000.0f); // in ms
-        int fps = int(1000.0f/avgFrameTime);
-        SDL_SetWindowTitle(m_window, 
-            std::string("Fluid Simulation - FPS: "+std::to_string(fps)+" ("+std::to_string(avgFrameTime)+" ms)").c_str());
-        m_timeSinceLastUpdate = 0;
-        m_numberOfFramesSinceLastUpdate = 0;
+    m_frameStatistics.addFrame(frameTime);
+    m_totalTime += frameTime;
+    m_timeSinceTitleUpdate += frameTime;
+    ++m_framesSinceTitleUpdate;
+    m_timeSinceStatistics += frameTime;
+    ++m_framesSinceStatistics;
+    // Show the median and tail frame lengths of the last second in the title bar
+    if (m_timeSinceTitleUpdate > m_titleInterval){
+        FrameStatistics::Summary summary = m_frameStatistics.summarise(m_framesSinceTitleUpdate);
+        char title[128];
+        std::snprintf(title, sizeof(title), "Fluid Simulation - FPS: %d (p50 %.1f ms, p99 %.1f ms, max %.1f ms)", 
+                      int(1000.0f / summary.mean), summary.p50, summary.p99, summary.max);
+        SDL_SetWindowTitle(m_window, title);
+        m_timeSinceTitleUpdate = 0;
+        m_framesSinceTitleUpdate = 0;
     }
+    // Log the full distribution less often
+    if (m_timeSinceStatistics > m_statisticsInterval){
+        FrameStatistics::Summary summary = m_frameStatistics.summarise(m_framesSinceStatistics);
+        FrameStatistics::log(m_timeSinceStatistics * 1e-6f, summary);
+        m_frameStatistics.writeCSV(m_totalTime * 1e-6f, summary);
+        m_timeSinceStatistics = 0;
+        m_framesSinceStatistics = 0;
+    }
+}
+
+// Also records each periodic summary of frame lengths in the given CSV file
+bool Window::writeFrameStatistics(std::string const& path){
+    return m_frameStatistics.openCSV(path);
 }
\ No newline at end of file
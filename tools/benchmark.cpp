@@ -0,0 +1,395 @@
+/*
+    Benchmarks the simulation and renderer headlessly on fixed scenes, so that builds and machines can be compared. Every
+    scene is run at every render resolution ("none" runs the simulation alone). Each run takes a number of warm-up
+    steps, then times a number of measured steps, all with a fixed time step and fixed solver iterations and at full
+    render resolution. Run from the directory the application runs in:
+
+        benchmark [--scenes settled-tank,dam-break,stirring] [--resolutions none,640x480,1280x960]
+                  [--warm-up steps] [--steps steps] [--time-step us] [--iterations diffusion pressure]
+                  [--json path] [--csv path] [--asset-pack path] [--slice-path name] [--disable feature]...
+
+    Each run reports steps per second, the mean GPU time of each stage, the divergence left in the velocity by the
+    pressure solve, the fraction of the tank holding fluid, and memory use, as JSON and CSV. The grid size is fixed
+    when building, so sweep it with a build per size. Built from the application's sources less src/main.cpp:
+
+        g++ tools/benchmark.cpp $(find src -name "*.c*" ! -name main.cpp) -o benchmark -I include -std=c++20 -O3
+            -DNDEBUG -DFLUID_HEADLESS -DFLUID_GRID_SIZE=64 -lSDL2 -lEGL -ldl -pthread
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <numbers>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <sys/resource.h>
+
+#include "headless.hpp"
+#include "asset_pack.hpp"
+
+#ifndef FLUID_HEADLESS
+#error The benchmark must be built with FLUID_HEADLESS defined
+#endif
+
+struct Scene{
+    char const* name;
+    std::vector<float> (*initialLevelSet)();
+    glm::vec3 (*force)(float time); // At a time in s
+};
+
+struct Resolution{
+    unsigned int width, height; // Zero for the simulation alone
+};
+
+struct Options{
+    std::vector<std::string> scenes{"settled-tank", "dam-break", "stirring"};
+    std::vector<Resolution> resolutions{{0, 0}, {640, 480}, {1280, 960}};
+    unsigned int warmUpSteps = 50;
+    unsigned int steps = 200;
+    unsigned int timeStep = 16667; // in us
+    int diffusionIterations = 25;
+    int pressureIterations = 50;
+    std::string jsonPath = "benchmark.json";
+    std::string csvPath = "benchmark.csv";
+    std::string assetPackPath = "assets.pack";
+};
+
+struct Result{
+    std::string scene;
+    Resolution resolution;
+    double seconds;
+    double stepsPerSecond;
+    std::vector<GPUStageTime> stageTimes;
+    double rmsDivergence, maxDivergence;
+    double fluidFraction;
+    std::size_t textureBytes; // Of the simulation
+    std::size_t peakResidentBytes; // Of the process so far
+};
+
+static std::size_t cellIndex(int i, int j, int k){
+    return (std::size_t)gridSize * gridSize * k + gridSize * j + i;
+}
+
+// Flat surface at half height, at rest - the application's initial state
+static std::vector<float> tankLevelSet(){
+    std::vector<float> levelSet(gridSize * gridSize * gridSize);
+    for (int k = 0 ; k < gridSize ; ++k){
+        for (int j = 0 ; j < gridSize ; ++j){
+            for (int i = 0 ; i < gridSize ; ++i){
+                levelSet[cellIndex(i, j, k)] = j - gridSize / 2;
+            }
+        }
+    }
+    return levelSet;
+}
+
+// A column of fluid against one wall, which collapses across the tank
+static std::vector<float> damBreakLevelSet(){
+    std::vector<float> levelSet(gridSize * gridSize * gridSize);
+    for (int k = 0 ; k < gridSize ; ++k){
+        for (int j = 0 ; j < gridSize ; ++j){
+            for (int i = 0 ; i < gridSize ; ++i){
+                levelSet[cellIndex(i, j, k)] = std::max(i - gridSize / 3, j - 3 * gridSize / 4);
+            }
+        }
+    }
+    return levelSet;
+}
+
+static glm::vec3 noForce(float){
+    return glm::vec3{0.0f, 0.0f, 0.0f};
+}
+
+// Turns once every two seconds, at about the size of force applied by dragging with the mouse
+static glm::vec3 stirringForce(float time){
+    float const angle = std::numbers::pi_v<float> * time;
+    return 5e-9f * glm::vec3{std::cos(angle), 0.0f, std::sin(angle)};
+}
+
+static Scene const scenes[] = {
+    {"settled-tank", tankLevelSet, noForce},
+    {"dam-break", damBreakLevelSet, noForce},
+    {"stirring", tankLevelSet, stirringForce}
+};
+
+static std::vector<std::string> split(std::string const& list){
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    for (std::string item ; std::getline(stream, item, ',') ;){
+        items.push_back(item);
+    }
+    return items;
+}
+
+static std::string resolutionName(Resolution const& resolution){
+    return resolution.width ? std::to_string(resolution.width) + "x" + std::to_string(resolution.height) : "none";
+}
+
+static Options parseCommandLine(int argc, char* argv[]){
+    Options options;
+    for (int i = 1 ; i < argc ; ++i){
+        std::string const argument = argv[i];
+        if (argument == "--scenes" && i + 1 < argc){
+            options.scenes = split(argv[++i]);
+        }
+        else if (argument == "--resolutions" && i + 1 < argc){
+            options.resolutions.clear();
+            for (std::string const& name : split(argv[++i])){
+                Resolution resolution{0, 0};
+                if (name != "none" && std::sscanf(name.c_str(), "%ux%u", &resolution.width, &resolution.height) != 2){
+                    throw std::runtime_error("Unknown resolution " + name);
+                }
+                options.resolutions.push_back(resolution);
+            }
+        }
+        else if (argument == "--warm-up" && i + 1 < argc){
+            options.warmUpSteps = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--steps" && i + 1 < argc){
+            options.steps = std::max(1u, (unsigned int)std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--time-step" && i + 1 < argc){
+            options.timeStep = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--iterations" && i + 2 < argc){
+            options.diffusionIterations = std::atoi(argv[++i]);
+            options.pressureIterations = std::atoi(argv[++i]);
+        }
+        else if (argument == "--json" && i + 1 < argc){
+            options.jsonPath = argv[++i];
+        }
+        else if (argument == "--csv" && i + 1 < argc){
+            options.csvPath = argv[++i];
+        }
+        else if (argument == "--asset-pack" && i + 1 < argc){
+            options.assetPackPath = argv[++i];
+        }
+        else if (argument == "--slice-path" && i + 1 < argc){
+            if (!Capabilities::forceSlicePath(argv[++i])){
+                throw std::runtime_error(std::string("Unknown slice path ") + argv[i]);
+            }
+        }
+        else if (argument == "--disable" && i + 1 < argc){
+            if (!Capabilities::disable(argv[++i])){
+                throw std::runtime_error(std::string("Unknown feature ") + argv[i]);
+            }
+        }
+        else{
+            throw std::runtime_error("Unrecognised argument " + argument);
+        }
+    }
+    for (std::string const& name : options.scenes){
+        if (std::none_of(std::begin(scenes), std::end(scenes), [&name](Scene const& scene){ return name == scene.name; })){
+            throw std::runtime_error("Unknown scene " + name);
+        }
+    }
+    return options;
+}
+
+// Divergence of the velocity in the fluid cells away from the walls, as divergence.frag computes it, along with the
+// fraction of those cells holding fluid (which drifts as the level set loses volume)
+static void measureResidual(FluidSimulator const& simulator, Result& result){
+    std::vector<float> velocity(3 * gridSize * gridSize * gridSize), levelSet(gridSize * gridSize * gridSize);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    GLStateCache::bindTexture(GL_TEXTURE_3D, simulator.getVelocity());
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RGB, GL_FLOAT, velocity.data());
+    GLStateCache::bindTexture(GL_TEXTURE_3D, simulator.getCurrentLevelSet());
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, levelSet.data());
+
+    double sumSquares = 0.0, maximum = 0.0;
+    std::size_t numFluidCells = 0;
+    for (int k = 1 ; k < gridSize - 1 ; ++k){
+        for (int j = 1 ; j < gridSize - 1 ; ++j){
+            for (int i = 1 ; i < gridSize - 1 ; ++i){
+                if (levelSet[cellIndex(i, j, k)] > 0.0f){
+                    continue;
+                }
+                double const divergence = (velocity[3 * cellIndex(i + 1, j, k)] - velocity[3 * cellIndex(i - 1, j, k)]
+                                         + velocity[3 * cellIndex(i, j + 1, k) + 1] - velocity[3 * cellIndex(i, j - 1, k) + 1]
+                                         + velocity[3 * cellIndex(i, j, k + 1) + 2] - velocity[3 * cellIndex(i, j, k - 1) + 2]) * gridSize / 2.0;
+                sumSquares += divergence * divergence;
+                maximum = std::max(maximum, std::abs(divergence));
+                ++numFluidCells;
+            }
+        }
+    }
+    result.rmsDivergence = numFluidCells ? std::sqrt(sumSquares / numFluidCells) : 0.0;
+    result.maxDivergence = maximum;
+    result.fluidFraction = (double)numFluidCells / ((gridSize - 2) * (gridSize - 2) * (gridSize - 2));
+}
+
+static Result run(Scene const& scene, Resolution const& resolution, Options const& options){
+    Result result{};
+    result.scene = scene.name;
+    result.resolution = resolution;
+    FluidSimulator simulator;
+    std::unique_ptr<FluidRenderer> renderer;
+    if (resolution.width){
+        renderer = std::make_unique<FluidRenderer>(resolution.width, resolution.height);
+        renderer->setAdaptiveResolution(false);
+    }
+    simulator.initialiseShaders();
+    if (!simulator.successfullyInitialised() || (renderer && !renderer->successfullyInitialised())){
+        throw std::runtime_error(std::string("Failed to initialise ") + scene.name);
+    }
+    simulator.setSolverIterations(options.diffusionIterations, options.pressureIterations);
+    simulator.setInitialLevelSet(scene.initialLevelSet());
+
+    auto step = [&](unsigned int i){
+        simulator.updateAppliedForce(scene.force(i * options.timeStep * 1e-6f));
+        simulator.update(options.timeStep);
+        if (renderer){
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderer->render(simulator.getRenderLevelSet(), simulator.getDetailCoordinates(), simulator.getLevelSetGeneration());
+        }
+        GLCallCounter::endFrame();
+        GLStateCache::endFrame();
+    };
+    for (unsigned int i = 0 ; i < options.warmUpSteps ; ++i){
+        step(i);
+    }
+    glFinish();
+    GPUTimer::resetMeans();
+    auto const tStart = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0 ; i < options.steps ; ++i){
+        step(options.warmUpSteps + i);
+    }
+    glFinish();
+    result.seconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - tStart).count() * 1e-6;
+    result.stepsPerSecond = options.steps / result.seconds;
+
+    simulator.getStageTimes(result.stageTimes);
+    if (renderer){
+        renderer->getStageTimes(result.stageTimes);
+    }
+    measureResidual(simulator, result);
+    result.textureBytes = simulator.getTextureBytes();
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakResidentBytes = (std::size_t)usage.ru_maxrss * 1024; // in KiB on Linux
+    return result;
+}
+
+static std::string jsonString(std::string const& text){
+    std::string result = "\"";
+    for (char c : text){
+        result += (c == '"' || c == '\\') ? std::string("\\") + c : std::string(1, c);
+    }
+    return result + "\"";
+}
+
+static bool writeJSON(std::string const& path, Options const& options, std::vector<Result> const& results){
+    std::ofstream file(path);
+    file << "{\n"
+         << "  \"renderer\": " << jsonString((char const*)glGetString(GL_RENDERER)) << ",\n"
+         << "  \"version\": " << jsonString((char const*)glGetString(GL_VERSION)) << ",\n"
+         << "  \"gridSize\": " << gridSize << ",\n"
+         << "  \"renderGridSize\": " << renderGridSize << ",\n"
+         << "  \"timeStep\": " << options.timeStep << ",\n"
+         << "  \"diffusionIterations\": " << options.diffusionIterations << ",\n"
+         << "  \"pressureIterations\": " << options.pressureIterations << ",\n"
+         << "  \"warmUpSteps\": " << options.warmUpSteps << ",\n"
+         << "  \"steps\": " << options.steps << ",\n"
+         << "  \"runs\": [";
+    for (std::size_t i = 0 ; i < results.size() ; ++i){
+        Result const& result = results[i];
+        file << (i ? ",\n" : "\n") << "    {\n"
+             << "      \"scene\": " << jsonString(result.scene) << ",\n"
+             << "      \"resolution\": " << jsonString(resolutionName(result.resolution)) << ",\n"
+             << "      \"seconds\": " << result.seconds << ",\n"
+             << "      \"stepsPerSecond\": " << result.stepsPerSecond << ",\n"
+             << "      \"stageTimes\": {";
+        for (std::size_t j = 0 ; j < result.stageTimes.size() ; ++j){
+            file << (j ? ", " : "") << jsonString(result.stageTimes[j].name) << ": " << result.stageTimes[j].meanTime;
+        }
+        file << "},\n"
+             << "      \"rmsDivergence\": " << result.rmsDivergence << ",\n"
+             << "      \"maxDivergence\": " << result.maxDivergence << ",\n"
+             << "      \"fluidFraction\": " << result.fluidFraction << ",\n"
+             << "      \"textureBytes\": " << result.textureBytes << ",\n"
+             << "      \"peakResidentBytes\": " << result.peakResidentBytes << "\n"
+             << "    }";
+    }
+    file << "\n  ]\n}\n";
+    return (bool)file;
+}
+
+// One row per run. Stages missing from a run (e.g. rendering, without a renderer) are left empty
+static bool writeCSV(std::string const& path, std::vector<Result> const& results){
+    std::vector<std::string> stageNames;
+    for (Result const& result : results){
+        for (GPUStageTime const& stageTime : result.stageTimes){
+            if (std::find(stageNames.begin(), stageNames.end(), stageTime.name) == stageNames.end()){
+                stageNames.push_back(stageTime.name);
+            }
+        }
+    }
+    std::ofstream file(path);
+    file << "grid_size,scene,resolution,seconds,steps_per_second,rms_divergence,max_divergence,fluid_fraction,texture_bytes,peak_resident_bytes";
+    for (std::string const& name : stageNames){
+        file << "," << name << " (ms)";
+    }
+    file << "\n";
+    for (Result const& result : results){
+        file << gridSize << "," << result.scene << "," << resolutionName(result.resolution) << "," << result.seconds << "," << result.stepsPerSecond << ","
+             << result.rmsDivergence << "," << result.maxDivergence << "," << result.fluidFraction << "," << result.textureBytes << "," << result.peakResidentBytes;
+        for (std::string const& name : stageNames){
+            auto stageTime = std::find_if(result.stageTimes.begin(), result.stageTimes.end(), [&name](GPUStageTime const& stageTime){
+                return name == stageTime.name;
+            });
+            file << ",";
+            if (stageTime != result.stageTimes.end()){
+                file << stageTime->meanTime;
+            }
+        }
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+int main(int argc, char* argv[]){
+    try{
+        Options const options = parseCommandLine(argc, argv);
+        if (AssetPack::open(options.assetPackPath)){
+            std::cout << "Loading assets from " << options.assetPackPath << "\n";
+        }
+        // Every resolution renders into a corner of one offscreen framebuffer
+        unsigned int width = 1, height = 1;
+        for (Resolution const& resolution : options.resolutions){
+            width = std::max(width, resolution.width);
+            height = std::max(height, resolution.height);
+        }
+        HeadlessContext context(width, height);
+        if (!context.successfullyInitialised()){
+            return EXIT_FAILURE;
+        }
+
+        std::vector<Result> results;
+        for (std::string const& name : options.scenes){
+            Scene const& scene = *std::find_if(std::begin(scenes), std::end(scenes), [&name](Scene const& scene){ return name == scene.name; });
+            for (Resolution const& resolution : options.resolutions){
+                results.push_back(run(scene, resolution, options));
+                Result const& result = results.back();
+                std::cout << "[BENCHMARK]: " << result.scene << " at grid " << gridSize << ", render " << resolutionName(resolution) << ": "
+                          << result.stepsPerSecond << " steps/s, divergence " << result.rmsDivergence << " RMS\n";
+            }
+        }
+        if (!writeJSON(options.jsonPath, options, results) || !writeCSV(options.csvPath, results)){
+            throw std::runtime_error("Failed to write " + options.jsonPath + " or " + options.csvPath);
+        }
+        std::cout << "Results written to " << options.jsonPath << " and " << options.csvPath << "\n";
+    }
+    catch(std::exception const& e){
+        std::cerr << "[ERROR]: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
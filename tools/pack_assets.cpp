@@ -0,0 +1,265 @@
+/*
+    Builds the asset pack read by AssetPack. Run from the directory the application runs in, so that the packed names
+    match the relative paths the application uses:
+
+        pack_assets assets.pack [--bc1 prefix]... shaders skybox res
+
+    Directories are packed recursively. Images (.tga, .png, .jpg, .bmp) are stored decoded, and RGB images whose names
+    start with a --bc1 prefix (e.g. --bc1 skybox) are stored BC1-compressed instead. Everything else is stored as is.
+
+    g++ tools/pack_assets.cpp src/asset_pack.cpp src/stb_image.cpp -o pack_assets -I include -std=c++20 -O2
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "stb_image.h"
+#include "asset_pack.hpp"
+
+struct PackedAsset{
+    std::string name;
+    AssetPack::Entry entry;
+    std::vector<unsigned char> payload;
+};
+
+static bool isImage(std::filesystem::path const& path){
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return std::tolower(c); });
+    return extension == ".tga" || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp";
+}
+
+static std::uint16_t toRGB565(float const colour[3]){
+    auto quantise = [](float value, int maximum){
+        return (std::uint16_t)std::clamp((int)std::lround(value / 255.0f * maximum), 0, maximum);
+    };
+    return quantise(colour[0], 31) << 11 | quantise(colour[1], 63) << 5 | quantise(colour[2], 31);
+}
+
+static void fromRGB565(std::uint16_t colour, float result[3]){
+    result[0] = ((colour >> 11) & 31) * 255 / 31;
+    result[1] = ((colour >> 5) & 63) * 255 / 63;
+    result[2] = (colour & 31) * 255 / 31;
+}
+
+// Endpoints are the extremes of the block's colours along their principal axis, always in four-colour mode
+static void encodeBC1Block(float const block[16][3], unsigned char* output){
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0 ; i < 16 ; ++i){
+        for (int c = 0 ; c < 3 ; ++c){
+            mean[c] += block[i][c] / 16.0f;
+        }
+    }
+    float covariance[3][3] = {};
+    for (int i = 0 ; i < 16 ; ++i){
+        for (int r = 0 ; r < 3 ; ++r){
+            for (int c = 0 ; c < 3 ; ++c){
+                covariance[r][c] += (block[i][r] - mean[r]) * (block[i][c] - mean[c]);
+            }
+        }
+    }
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0 ; iteration < 8 ; ++iteration){
+        float next[3] = {};
+        for (int r = 0 ; r < 3 ; ++r){
+            for (int c = 0 ; c < 3 ; ++c){
+                next[r] += covariance[r][c] * axis[c];
+            }
+        }
+        float const length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f){
+            break;
+        }
+        for (int c = 0 ; c < 3 ; ++c){
+            axis[c] = next[c] / length;
+        }
+    }
+    float minimum = 1e30f, maximum = -1e30f;
+    for (int i = 0 ; i < 16 ; ++i){
+        float const projection = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+        minimum = std::min(minimum, projection);
+        maximum = std::max(maximum, projection);
+    }
+    float endpoints[2][3];
+    for (int c = 0 ; c < 3 ; ++c){
+        endpoints[0][c] = mean[c] + axis[c] * maximum;
+        endpoints[1][c] = mean[c] + axis[c] * minimum;
+    }
+    std::uint16_t colour0 = toRGB565(endpoints[0]), colour1 = toRGB565(endpoints[1]);
+    if (colour0 < colour1){
+        std::swap(colour0, colour1);
+    }
+
+    std::uint32_t indices = 0;
+    if (colour0 != colour1){ // Otherwise every index is 0
+        float palette[4][3];
+        fromRGB565(colour0, palette[0]);
+        fromRGB565(colour1, palette[1]);
+        for (int c = 0 ; c < 3 ; ++c){
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0 ; i < 16 ; ++i){
+            int best = 0;
+            float bestDistance = 1e30f;
+            for (int p = 0 ; p < 4 ; ++p){
+                float distance = 0.0f;
+                for (int c = 0 ; c < 3 ; ++c){
+                    distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+                }
+                if (distance < bestDistance){
+                    best = p;
+                    bestDistance = distance;
+                }
+            }
+            indices |= (std::uint32_t)best << (2 * i);
+        }
+    }
+    std::uint32_t const words[2] = {(std::uint32_t)colour0 | (std::uint32_t)colour1 << 16, indices};
+    std::memcpy(output, words, sizeof(words));
+}
+
+// Blocks overhanging the image repeat its last row and column
+static std::vector<unsigned char> encodeBC1(unsigned char const* pixels, int width, int height, int components){
+    std::vector<unsigned char> result;
+    for (int blockY = 0 ; blockY < height ; blockY += 4){
+        for (int blockX = 0 ; blockX < width ; blockX += 4){
+            float block[16][3];
+            for (int y = 0 ; y < 4 ; ++y){
+                for (int x = 0 ; x < 4 ; ++x){
+                    unsigned char const* pixel = pixels + components * ((std::size_t)std::min(blockY + y, height - 1) * width + std::min(blockX + x, width - 1));
+                    for (int c = 0 ; c < 3 ; ++c){
+                        block[4 * y + x][c] = pixel[c];
+                    }
+                }
+            }
+            result.resize(result.size() + 8);
+            encodeBC1Block(block, result.data() + result.size() - 8);
+        }
+    }
+    return result;
+}
+
+static bool packFile(std::filesystem::path const& path, std::vector<std::string> const& bc1Prefixes, std::vector<PackedAsset>& assets){
+    PackedAsset asset;
+    asset.name = AssetPack::normalise(path.generic_string());
+    asset.entry = AssetPack::Entry{0, 0, 0, 0, AssetPack::Kind::file, 0, 0, 0};
+    if (isImage(path)){
+        int width, height, components;
+        unsigned char* pixels = stbi_load(path.string().c_str(), &width, &height, &components, 0);
+        if (!pixels){
+            std::cerr << "[ERROR]: Failed to decode " << path.string() << "\n";
+            return false;
+        }
+        bool const compress = components == 3 && std::any_of(bc1Prefixes.begin(), bc1Prefixes.end(), [&asset](std::string const& prefix){
+            return asset.name.compare(0, prefix.size(), prefix) == 0;
+        });
+        if (compress){
+            asset.payload = encodeBC1(pixels, width, height, components);
+        }
+        else{
+            asset.payload.assign(pixels, pixels + (std::size_t)width * height * components);
+        }
+        stbi_image_free(pixels);
+        asset.entry.kind = compress ? AssetPack::Kind::imageBC1 : AssetPack::Kind::image;
+        asset.entry.width = width;
+        asset.entry.height = height;
+        asset.entry.components = components;
+    }
+    else{
+        std::ifstream file(path, std::ios::binary);
+        if (!file){
+            std::cerr << "[ERROR]: Failed to read " << path.string() << "\n";
+            return false;
+        }
+        asset.payload.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    asset.entry.size = asset.payload.size();
+    assets.push_back(std::move(asset));
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    if (argc < 3){
+        std::cerr << "Usage: pack_assets output [--bc1 prefix]... directory-or-file...\n";
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> bc1Prefixes;
+    std::vector<std::filesystem::path> paths;
+    for (int i = 2 ; i < argc ; ++i){
+        std::string const argument = argv[i];
+        if (argument == "--bc1" && i + 1 < argc){
+            bc1Prefixes.push_back(AssetPack::normalise(argv[++i]));
+        }
+        else if (std::filesystem::is_directory(argument)){
+            for (auto const& file : std::filesystem::recursive_directory_iterator(argument)){
+                if (file.is_regular_file()){
+                    paths.push_back(file.path());
+                }
+            }
+        }
+        else{
+            paths.push_back(argument);
+        }
+    }
+
+    std::vector<PackedAsset> assets;
+    for (auto const& path : paths){
+        if (!packFile(path, bc1Prefixes, assets)){
+            return EXIT_FAILURE;
+        }
+    }
+    std::sort(assets.begin(), assets.end(), [](PackedAsset const& a, PackedAsset const& b){
+        return a.name < b.name;
+    });
+    for (std::size_t i = 1 ; i < assets.size() ; ++i){
+        if (assets[i].name == assets[i - 1].name){
+            std::cerr << "[ERROR]: " << assets[i].name << " was given more than once\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Lay out the index, names and payloads
+    std::string names;
+    for (PackedAsset& asset : assets){
+        asset.entry.nameOffset = (std::uint32_t)names.size();
+        asset.entry.nameLength = (std::uint32_t)asset.name.size();
+        names += asset.name;
+    }
+    AssetPack::Header const header{AssetPack::fileMagic, AssetPack::fileVersion, (std::uint32_t)assets.size(), (std::uint32_t)names.size()};
+    std::uint64_t offset = sizeof(header) + assets.size() * sizeof(AssetPack::Entry) + names.size();
+    for (PackedAsset& asset : assets){
+        offset = (offset + AssetPack::payloadAlignment - 1) / AssetPack::payloadAlignment * AssetPack::payloadAlignment;
+        asset.entry.offset = offset;
+        offset += asset.entry.size;
+    }
+
+    std::ofstream output(argv[1], std::ios::binary | std::ios::trunc);
+    output.write((char const*)&header, sizeof(header));
+    for (PackedAsset const& asset : assets){
+        output.write((char const*)&asset.entry, sizeof(asset.entry));
+    }
+    output.write(names.data(), names.size());
+    for (PackedAsset const& asset : assets){
+        std::vector<char> const padding(asset.entry.offset - (std::uint64_t)output.tellp(), 0);
+        output.write(padding.data(), padding.size());
+        output.write((char const*)asset.payload.data(), asset.payload.size());
+    }
+    if (!output){
+        std::cerr << "[ERROR]: Failed to write " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+    std::size_t numCompressed = std::count_if(assets.begin(), assets.end(), [](PackedAsset const& asset){
+        return asset.entry.kind == AssetPack::Kind::imageBC1;
+    });
+    std::cout << "Packed " << assets.size() << " assets (" << numCompressed << " BC1-compressed) into " << argv[1] << ": " << offset / 1024 << " KiB\n";
+    return EXIT_SUCCESS;
+}
\ No newline at end of file